@@ -1,5 +1,6 @@
 #include "adc.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include "esp_log.h"
 #include "freertos/task.h"
 
@@ -12,10 +13,12 @@ typedef struct {
     adc_callback_t cb;
 
     adc_oneshot_unit_handle_t adc_handle;
-    adc_cali_handle_t cali_handle;
-    bool calibrated;
+    const adc_tool_lut_t *lut;
 } adc_task_cfg_t;
 
+static adc_tool_lut_t *s_luts[ADC_TOOL_LUT_MAX];
+static portMUX_TYPE s_lut_lock = portMUX_INITIALIZER_UNLOCKED;
+
 static bool adc_tool_calibration_init(
         adc_unit_t unit,
         adc_channel_t channel,
@@ -49,8 +52,8 @@ static void adc_read_task(void *arg)
     while (1) {
         ESP_ERROR_CHECK(adc_oneshot_read(cfg->adc_handle, cfg->channel, &raw));
 
-        if (cfg->calibrated) {
-            ESP_ERROR_CHECK(adc_cali_raw_to_voltage(cfg->cali_handle, raw, &voltage));
+        if (cfg->lut) {
+            voltage = adc_tool_lut_mv(cfg->lut, raw);
         }
 
         if (cfg->cb) {
@@ -81,7 +84,6 @@ esp_err_t adc_tool_start(
     cfg->atten = atten;
     cfg->cb = callback;
     cfg->adc_handle = NULL;
-    cfg->cali_handle = NULL;
 
     ESP_ERROR_CHECK(adc_tool_init_unit(unit, &cfg->adc_handle));
 
@@ -93,8 +95,8 @@ esp_err_t adc_tool_start(
 
     ESP_ERROR_CHECK(adc_oneshot_config_channel(cfg->adc_handle, channel, &chan_cfg));
 
-    /* Calibration */
-    cfg->calibrated = adc_tool_calibration_init(unit, channel, atten, &cfg->cali_handle);
+    /* Calibration：查表代替逐样本调用 adc_cali_raw_to_voltage */
+    cfg->lut = adc_tool_lut_get(unit, atten);
 
     /* Create task */
     xTaskCreate(adc_read_task, "adc_read_task", 4096, cfg, 5, NULL);
@@ -102,6 +104,101 @@ esp_err_t adc_tool_start(
     return ESP_OK;
 }
 
+/* -------------------------------------------------------------------------- */
+/*                            CALIBRATION LUT                                 */
+/* -------------------------------------------------------------------------- */
+
+/* 未校准时使用的标称满量程（mV） */
+static int adc_tool_nominal_full_scale(adc_atten_t atten)
+{
+    switch (atten) {
+        case ADC_ATTEN_DB_0:   return 750;
+        case ADC_ATTEN_DB_2_5: return 1050;
+        case ADC_ATTEN_DB_6:   return 1300;
+        default:               return 2500;
+    }
+}
+
+static adc_tool_lut_t *adc_tool_lut_build(adc_unit_t unit, adc_atten_t atten)
+{
+    adc_tool_lut_t *lut = malloc(sizeof(adc_tool_lut_t));
+    if (!lut) return NULL;
+
+    lut->unit = unit;
+    lut->atten = atten;
+
+    /* 校准曲线与通道无关，使用通道 0 创建 */
+    adc_cali_handle_t cali = NULL;
+    lut->calibrated = adc_tool_calibration_init(unit, ADC_CHANNEL_0, atten, &cali);
+
+    const int full_scale = adc_tool_nominal_full_scale(atten);
+    for (int raw = 0; raw < ADC_TOOL_LUT_SIZE; raw++) {
+        int mv = raw * full_scale / (ADC_TOOL_LUT_SIZE - 1);
+        if (lut->calibrated && adc_cali_raw_to_voltage(cali, raw, &mv) != ESP_OK) {
+            mv = raw * full_scale / (ADC_TOOL_LUT_SIZE - 1);
+        }
+        lut->mv[raw] = (uint16_t)(mv < 0 ? 0 : mv);
+    }
+
+    if (cali) {
+        adc_tool_calibration_deinit(cali);
+    }
+
+    ESP_LOGI(TAG, "Calibration LUT built: unit=%d, atten=%d, %s, 4095 -> %d mV",
+             unit, atten, lut->calibrated ? "calibrated" : "nominal", lut->mv[ADC_TOOL_LUT_SIZE - 1]);
+    return lut;
+}
+
+const adc_tool_lut_t *adc_tool_lut_get(adc_unit_t unit, adc_atten_t atten)
+{
+    portENTER_CRITICAL(&s_lut_lock);
+    for (int i = 0; i < ADC_TOOL_LUT_MAX; i++) {
+        if (s_luts[i] && s_luts[i]->unit == unit && s_luts[i]->atten == atten) {
+            portEXIT_CRITICAL(&s_lut_lock);
+            return s_luts[i];
+        }
+    }
+    portEXIT_CRITICAL(&s_lut_lock);
+
+    /* 在锁外生成，发布时若已被其他任务抢先则丢弃自己的表 */
+    adc_tool_lut_t *lut = adc_tool_lut_build(unit, atten);
+    if (!lut) return NULL;
+
+    adc_tool_lut_t *result = NULL;
+    int free_slot = -1;
+    portENTER_CRITICAL(&s_lut_lock);
+    for (int i = 0; i < ADC_TOOL_LUT_MAX; i++) {
+        if (s_luts[i] && s_luts[i]->unit == unit && s_luts[i]->atten == atten) {
+            result = s_luts[i];
+            break;
+        }
+        if (!s_luts[i] && free_slot < 0) {
+            free_slot = i;
+        }
+    }
+    if (!result && free_slot >= 0) {
+        s_luts[free_slot] = lut;
+        result = lut;
+    }
+    portEXIT_CRITICAL(&s_lut_lock);
+
+    if (result != lut) {
+        free(lut);
+        if (!result) {
+            ESP_LOGE(TAG, "No free LUT slot for unit=%d, atten=%d", unit, atten);
+        }
+    }
+    return result;
+}
+
+void adc_tool_lut_convert(const adc_tool_lut_t *lut, const uint16_t *raw, uint16_t *mv, size_t n)
+{
+    const uint16_t *table = lut->mv;
+    for (size_t i = 0; i < n; i++) {
+        mv[i] = table[raw[i] & (ADC_TOOL_LUT_SIZE - 1)];
+    }
+}
+
 /* -------------------------------------------------------------------------- */
 /*                               ADC DEINIT                                   */
 /* -------------------------------------------------------------------------- */
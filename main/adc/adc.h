@@ -13,6 +13,19 @@ extern "C" {
 
     typedef void (*adc_callback_t)(int raw, int voltage_mv);
 
+#define ADC_TOOL_LUT_SIZE   (1 << SOC_ADC_DIGI_MAX_BITWIDTH)
+#define ADC_TOOL_LUT_MAX    4   // 缓存的 (unit, atten) 组合数量
+
+    /**
+     * @brief 原始值 -> 毫伏查找表，按 (unit, atten) 共享
+     */
+    typedef struct {
+        adc_unit_t unit;
+        adc_atten_t atten;
+        bool calibrated;                    // false 时为按标称量程的线性近似
+        uint16_t mv[ADC_TOOL_LUT_SIZE];
+    } adc_tool_lut_t;
+
     /**
      * @brief 初始化一个 ADC 单元并返回 handle
      */
@@ -32,6 +45,24 @@ extern "C" {
             adc_atten_t atten,
             adc_callback_t callback);
 
+    /**
+     * @brief 获取 (unit, atten) 对应的校准查找表，首次调用时由校准曲线生成
+     */
+    const adc_tool_lut_t* adc_tool_lut_get(adc_unit_t unit, adc_atten_t atten);
+
+    /**
+     * @brief 单个原始值转换为毫伏
+     */
+    static inline int adc_tool_lut_mv(const adc_tool_lut_t* lut, int raw)
+    {
+        return lut->mv[raw & (ADC_TOOL_LUT_SIZE - 1)];
+    }
+
+    /**
+     * @brief 批量转换，raw 与 mv 可以是同一数组
+     */
+    void adc_tool_lut_convert(const adc_tool_lut_t* lut, const uint16_t* raw, uint16_t* mv, size_t n);
+
     /**
      * @brief 注销 ADC（如需要）
      */
@@ -0,0 +1,135 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+#include "adc_filter.h"
+
+#include <string.h>
+
+#include "esp_log.h"
+
+static const char* TAG = "ADC_FILTER";
+
+#define ADC_RAW_BITS    12
+#define IIR_FRAC_BITS   8
+
+esp_err_t adc_decim_init(adc_decim_t* f, const adc_decim_config_t* config)
+{
+    if (f == NULL || config == NULL || config->extra_bits > config->log2_ratio) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const uint8_t order = config->type == ADC_DECIM_CIC ? config->order : 1;
+    if (order == 0 || order > ADC_DECIM_MAX_ORDER) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* 增益 R^N，整个位宽增长必须装进 int32（积分器允许回绕，但输出不能） */
+    const uint32_t growth = (uint32_t)order * config->log2_ratio;
+    if (ADC_RAW_BITS + growth > 31 || ADC_RAW_BITS + config->extra_bits + IIR_FRAC_BITS > 31) {
+        ESP_LOGE(TAG, "Ratio 2^%u with order %u overflows int32", config->log2_ratio, order);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(f, 0, sizeof(*f));
+    f->cfg = *config;
+    f->cfg.order = order;
+    f->out_shift = (uint8_t)(growth - config->extra_bits);
+    f->warmup = config->type == ADC_DECIM_CIC ? order : 0;
+    return ESP_OK;
+}
+
+void adc_decim_reset(adc_decim_t* f)
+{
+    f->phase = 0;
+    f->warmup = f->cfg.type == ADC_DECIM_CIC ? f->cfg.order : 0;
+    memset(f->integ, 0, sizeof(f->integ));
+    memset(f->comb, 0, sizeof(f->comb));
+    f->iir = 0;
+    f->iir_primed = false;
+}
+
+static inline int32_t iir_step(adc_decim_t* f, int32_t x)
+{
+    if (f->cfg.iir_shift == 0) {
+        return x;
+    }
+
+    const int32_t xs = x << IIR_FRAC_BITS;
+    if (!f->iir_primed) {
+        f->iir = xs;
+        f->iir_primed = true;
+    } else {
+        f->iir += (xs - f->iir) >> f->cfg.iir_shift;
+    }
+    return (f->iir + (1 << (IIR_FRAC_BITS - 1))) >> IIR_FRAC_BITS;
+}
+
+size_t adc_decim_process(adc_decim_t* f, const uint16_t* in, size_t n, int32_t* out)
+{
+    const uint32_t ratio = 1u << f->cfg.log2_ratio;
+    const int order = f->cfg.order;
+    const int32_t round = f->out_shift ? (1 << (f->out_shift - 1)) : 0;
+    size_t produced = 0;
+
+    if (f->cfg.type == ADC_DECIM_BOXCAR) {
+        int32_t acc = f->integ[0];
+        uint32_t phase = f->phase;
+        for (size_t i = 0; i < n; i++) {
+            acc += in[i] & ((1 << ADC_RAW_BITS) - 1);
+            if (++phase == ratio) {
+                out[produced++] = iir_step(f, (acc + round) >> f->out_shift);
+                acc = 0;
+                phase = 0;
+            }
+        }
+        f->integ[0] = acc;
+        f->phase = phase;
+        return produced;
+    }
+
+    /* CIC：积分器运行于输入速率，梳状器（差分延迟 1）运行于输出速率 */
+    for (size_t i = 0; i < n; i++) {
+        int32_t x = in[i] & ((1 << ADC_RAW_BITS) - 1);
+        for (int k = 0; k < order; k++) {
+            f->integ[k] = (int32_t)((uint32_t)f->integ[k] + (uint32_t)x);
+            x = f->integ[k];
+        }
+
+        if (++f->phase < ratio) {
+            continue;
+        }
+        f->phase = 0;
+
+        int32_t y = x;
+        for (int k = 0; k < order; k++) {
+            const int32_t prev = f->comb[k];
+            f->comb[k] = y;
+            y = (int32_t)((uint32_t)y - (uint32_t)prev);
+        }
+        if (f->warmup) {
+            f->warmup--;
+            f->iir_primed = false;
+        }
+        out[produced++] = iir_step(f, (y + round) >> f->out_shift);
+    }
+    return produced;
+}
+
+int32_t adc_decim_to_uv(const adc_tool_lut_t* lut, int32_t value, uint8_t extra_bits)
+{
+    if (value < 0) {
+        value = 0;
+    }
+
+    int32_t raw = value >> extra_bits;
+    const int32_t frac = value & ((1 << extra_bits) - 1);
+    if (raw >= ADC_TOOL_LUT_SIZE - 1) {
+        return (int32_t)lut->mv[ADC_TOOL_LUT_SIZE - 1] * 1000;
+    }
+
+    /* 相邻表项间线性插值，保留过采样带来的额外位 */
+    const int32_t lo = (int32_t)lut->mv[raw] * 1000;
+    const int32_t hi = (int32_t)lut->mv[raw + 1] * 1000;
+    return lo + (((hi - lo) * frac) >> extra_bits);
+}
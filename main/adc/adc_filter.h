@@ -0,0 +1,74 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+#ifndef HEALTHY_MCU_ADC_FILTER_H
+#define HEALTHY_MCU_ADC_FILTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "adc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ADC_DECIM_MAX_ORDER 3
+
+    typedef enum {
+        ADC_DECIM_BOXCAR = 0,   // 每 R 个采样求和输出一次
+        ADC_DECIM_CIC,          // N 阶 CIC（积分-梳状），阻带衰减更好
+    } adc_decim_type_t;
+
+    /**
+     * @brief 过采样抽取配置
+     *
+     * 过采样 4^k 倍可获得 k 位额外分辨率（噪声需足够"白"），输出为 (12 + extra_bits) 位
+     */
+    typedef struct {
+        adc_decim_type_t type;
+        uint8_t log2_ratio;     // 抽取比 R = 2^log2_ratio
+        uint8_t order;          // CIC 阶数 N，BOXCAR 忽略
+        uint8_t extra_bits;     // 输出额外保留的位数，不超过 log2_ratio / 2 才有意义
+        uint8_t iir_shift;      // 输出端一阶 IIR：y += (x - y) >> iir_shift，0 表示关闭
+    } adc_decim_config_t;
+
+    /**
+     * @brief 单通道滤波状态，连续调用之间保持
+     */
+    typedef struct {
+        adc_decim_config_t cfg;
+        uint8_t out_shift;
+        uint32_t phase;         // 当前抽取周期内已累加的输入数，最大 2^19 - 1
+        uint8_t warmup;         // CIC 建立期内的输出不用于预置 IIR
+        int32_t integ[ADC_DECIM_MAX_ORDER];
+        int32_t comb[ADC_DECIM_MAX_ORDER];
+        int32_t iir;            // 带 8 位小数
+        bool iir_primed;
+    } adc_decim_t;
+
+    /**
+     * @brief 初始化滤波器状态
+     */
+    esp_err_t adc_decim_init(adc_decim_t* f, const adc_decim_config_t* config);
+
+    void adc_decim_reset(adc_decim_t* f);
+
+    /**
+     * @brief 处理一段原始采样，返回写入 out 的输出个数（最多 n / R + 1）
+     */
+    size_t adc_decim_process(adc_decim_t* f, const uint16_t* in, size_t n, int32_t* out);
+
+    /**
+     * @brief 将 (12 + extra_bits) 位输出经校准表插值换算为微伏
+     */
+    int32_t adc_decim_to_uv(const adc_tool_lut_t* lut, int32_t value, uint8_t extra_bits);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //HEALTHY_MCU_ADC_FILTER_H
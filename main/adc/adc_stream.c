@@ -0,0 +1,416 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+#include "adc_stream.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/ringbuf.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+static const char* TAG = "ADC_STREAM";
+
+#define ADC_STREAM_FRAME_CONV   64      // 每个 DMA 帧包含的转换次数（按通道数取整）
+#define ADC_STREAM_POLL_MS      100     // 任务检查停止标志的间隔
+#define ADC_STREAM_CHAN_LUT     16
+
+#if CONFIG_IDF_TARGET_ESP32 || CONFIG_IDF_TARGET_ESP32S2
+#define ADC_STREAM_OUTPUT_TYPE  ADC_DIGI_OUTPUT_FORMAT_TYPE1
+#define ADC_STREAM_GET_CHANNEL(p) ((p)->type1.channel)
+#define ADC_STREAM_GET_DATA(p)    ((p)->type1.data)
+#else
+#define ADC_STREAM_OUTPUT_TYPE  ADC_DIGI_OUTPUT_FORMAT_TYPE2
+#define ADC_STREAM_GET_CHANNEL(p) ((p)->type2.channel)
+#define ADC_STREAM_GET_DATA(p)    ((p)->type2.data)
+#endif
+
+typedef struct {
+    adc_stream_cb_t cb;
+    void* ctx;
+} adc_stream_sub_t;
+
+static adc_stream_config_t s_cfg;
+static adc_continuous_handle_t s_adc = NULL;
+static RingbufHandle_t s_ring = NULL;
+static TaskHandle_t s_reader_task = NULL;
+static SemaphoreHandle_t s_exit_sem = NULL;
+static volatile bool s_running = false;
+
+static uint8_t* s_dma_buf = NULL;
+static uint32_t s_dma_frame_bytes = 0;
+static size_t s_block_bytes = 0;
+static float s_conv_period_us = 0;
+
+/*
+ * 时间戳由转换计数推算：第 k 次转换的时刻 = s_anchor_us + k / sample_freq_hz。
+ * 一次读取可能取出积压的多个 DMA 帧，读取时刻不能代表采样时刻；
+ * 只有 DMA 溢出丢失数据后计数才失准，此时以读取时刻重新锚定。
+ */
+static int64_t s_anchor_us = 0;
+static uint64_t s_conv_count = 0;
+static uint32_t s_seen_overflows = 0;
+static int8_t s_chan_index[ADC_STREAM_CHAN_LUT];
+
+static adc_stream_sub_t s_subs[ADC_STREAM_MAX_SUBSCRIBERS];
+static portMUX_TYPE s_sub_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static adc_stream_stats_t s_stats;
+
+/* 当前正在填充的块（直接位于环形缓冲内部） */
+static adc_stream_block_t* s_cur = NULL;
+static uint32_t s_cur_total = 0;
+static uint32_t s_discard = 0;
+static uint32_t s_seq = 0;
+
+/* -------------------------------------------------------------------------- */
+/*                                DMA 回调                                     */
+/* -------------------------------------------------------------------------- */
+
+static bool IRAM_ATTR adc_stream_on_conv_done(adc_continuous_handle_t handle,
+                                              const adc_continuous_evt_data_t* edata, void* user_data)
+{
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_reader_task, &woken);
+    return woken == pdTRUE;
+}
+
+static bool IRAM_ATTR adc_stream_on_pool_ovf(adc_continuous_handle_t handle,
+                                             const adc_continuous_evt_data_t* edata, void* user_data)
+{
+    s_stats.dma_overflows++;
+    return false;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               块的申请与提交                                 */
+/* -------------------------------------------------------------------------- */
+
+static void block_commit(void)
+{
+    xRingbufferSendComplete(s_ring, s_cur);
+    s_cur = NULL;
+    s_cur_total = 0;
+    s_stats.blocks++;
+}
+
+static bool block_acquire(int64_t ts)
+{
+    void* item = NULL;
+    if (xRingbufferSendAcquire(s_ring, &item, s_block_bytes, 0) != pdTRUE) {
+        return false;
+    }
+
+    s_cur = (adc_stream_block_t*)item;
+    s_cur->seq = s_seq++;
+    s_cur->timestamp_us = ts;
+    s_cur->period_us = (uint32_t)(s_conv_period_us * s_cfg.num_channels);
+    s_cur->num_channels = s_cfg.num_channels;
+    s_cur->capacity = s_cfg.block_samples;
+    memcpy(s_cur->channel, s_cfg.channels, sizeof(s_cur->channel));
+    memset(s_cur->count, 0, sizeof(s_cur->count));
+    s_cur_total = 0;
+    return true;
+}
+
+/**
+ * @brief 将一个 DMA 帧解复用进环形缓冲中的当前块
+ */
+static inline int64_t conv_timestamp(uint64_t k)
+{
+    return s_anchor_us + (int64_t)(k * 1000000ull / s_cfg.sample_freq_hz);
+}
+
+static void demux_frame(const uint8_t* buf, uint32_t len)
+{
+    const uint32_t n = len / SOC_ADC_DIGI_RESULT_BYTES;
+    const uint32_t per_block = (uint32_t)s_cfg.block_samples * s_cfg.num_channels;
+
+    for (uint32_t i = 0; i < n; i++) {
+        const adc_digi_output_data_t* p = (const adc_digi_output_data_t*)&buf[i * SOC_ADC_DIGI_RESULT_BYTES];
+        const uint32_t chan = ADC_STREAM_GET_CHANNEL(p);
+        const int idx = chan < ADC_STREAM_CHAN_LUT ? s_chan_index[chan] : -1;
+        if (idx < 0) {
+            s_stats.foreign_samples++;
+            continue;
+        }
+
+        /* 某通道已满说明扫描序列错位，提前提交保持块内对齐 */
+        if (s_cur != NULL && s_cur->count[idx] >= s_cur->capacity) {
+            block_commit();
+        }
+
+        if (s_cur == NULL) {
+            if (!block_acquire(conv_timestamp(s_conv_count + i))) {
+                /* 订阅者处理不过来：丢弃一整块的数据量，序号照常递增以便检测丢块 */
+                if (++s_discard >= per_block) {
+                    s_discard = 0;
+                    s_seq++;
+                    s_stats.dropped_blocks++;
+                }
+                continue;
+            }
+            s_discard = 0;
+        }
+
+        s_cur->samples[idx * s_cur->capacity + s_cur->count[idx]++] = (uint16_t)ADC_STREAM_GET_DATA(p);
+        if (++s_cur_total >= per_block) {
+            block_commit();
+        }
+    }
+    s_conv_count += n;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   任务                                      */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief 把已提交的块依次交给订阅者并归还环形缓冲
+ */
+static void dispatch_blocks(void)
+{
+    adc_stream_sub_t subs[ADC_STREAM_MAX_SUBSCRIBERS];
+    size_t size = 0;
+    adc_stream_block_t* block;
+
+    while ((block = xRingbufferReceive(s_ring, &size, 0)) != NULL) {
+        portENTER_CRITICAL(&s_sub_lock);
+        memcpy(subs, s_subs, sizeof(subs));
+        portEXIT_CRITICAL(&s_sub_lock);
+
+        for (int i = 0; i < ADC_STREAM_MAX_SUBSCRIBERS; i++) {
+            if (subs[i].cb) {
+                subs[i].cb(block, subs[i].ctx);
+            }
+        }
+
+        vRingbufferReturnItem(s_ring, block);
+    }
+}
+
+/*
+ * 读取、解复用与分发在同一任务中完成：块在环形缓冲内原地填充，
+ * 每读空一次 DMA 池就把已满的块交给订阅者。订阅者耗时期间到达的数据
+ * 暂存在驱动的 DMA 池中（max_store_buf_size），超出时计入 dma_overflows。
+ */
+static void adc_stream_reader_task(void* arg)
+{
+    while (s_running) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ADC_STREAM_POLL_MS));
+
+        uint32_t len = 0;
+        while (s_running && adc_continuous_read(s_adc, s_dma_buf, s_dma_frame_bytes, &len, 0) == ESP_OK) {
+            if (s_stats.dma_overflows != s_seen_overflows) {
+                // 溢出丢掉的转换数未知，令本帧末尾对齐读取时刻
+                s_seen_overflows = s_stats.dma_overflows;
+                const uint64_t n = len / SOC_ADC_DIGI_RESULT_BYTES;
+                s_anchor_us = esp_timer_get_time() - (int64_t)((s_conv_count + n) * 1000000ull / s_cfg.sample_freq_hz);
+            }
+            demux_frame(s_dma_buf, len);
+        }
+        dispatch_blocks();
+    }
+
+    /* 未填满的块以部分数据提交并交付，避免环形缓冲中残留未完成的项 */
+    if (s_cur != NULL) {
+        block_commit();
+    }
+    dispatch_blocks();
+
+    xSemaphoreGive(s_exit_sem);
+    vTaskDelete(NULL);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  公共接口                                    */
+/* -------------------------------------------------------------------------- */
+
+esp_err_t adc_stream_start(const adc_stream_config_t* config)
+{
+    if (config == NULL || config->num_channels == 0 || config->num_channels > ADC_STREAM_MAX_CHANNELS ||
+        config->block_samples == 0 || config->ring_blocks == 0 ||
+        config->sample_freq_hz < SOC_ADC_SAMPLE_FREQ_THRES_LOW ||
+        config->sample_freq_hz > SOC_ADC_SAMPLE_FREQ_THRES_HIGH ||
+        !SOC_ADC_DIG_SUPPORTED_UNIT(config->unit)) {
+        ESP_LOGE(TAG, "Invalid stream configuration");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_running) {
+        ESP_LOGW(TAG, "Stream already running");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_cfg = *config;
+    memset(&s_stats, 0, sizeof(s_stats));
+    memset(s_chan_index, -1, sizeof(s_chan_index));
+    s_cur = NULL;
+    s_cur_total = 0;
+    s_discard = 0;
+    s_seq = 0;
+    s_conv_period_us = 1e6f / (float)s_cfg.sample_freq_hz;
+
+    adc_digi_pattern_config_t pattern[ADC_STREAM_MAX_CHANNELS] = {0};
+    for (int i = 0; i < s_cfg.num_channels; i++) {
+        if (s_cfg.channels[i] >= ADC_STREAM_CHAN_LUT) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        s_chan_index[s_cfg.channels[i]] = (int8_t)i;
+        pattern[i].atten = s_cfg.atten;
+        pattern[i].channel = s_cfg.channels[i];
+        pattern[i].unit = s_cfg.unit;
+        pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
+
+    s_block_bytes = (sizeof(adc_stream_block_t) + sizeof(uint16_t) * s_cfg.num_channels * s_cfg.block_samples + 3) & ~3u;
+    s_dma_frame_bytes = (uint32_t)s_cfg.num_channels * ADC_STREAM_FRAME_CONV * SOC_ADC_DIGI_RESULT_BYTES;
+
+    esp_err_t err = ESP_ERR_NO_MEM;
+    s_dma_buf = malloc(s_dma_frame_bytes);
+    /* NOSPLIT 每项额外 8 字节头部 */
+    s_ring = xRingbufferCreate((s_block_bytes + 8) * s_cfg.ring_blocks, RINGBUF_TYPE_NOSPLIT);
+    s_exit_sem = xSemaphoreCreateBinary();
+    if (s_dma_buf == NULL || s_ring == NULL || s_exit_sem == NULL) {
+        goto fail;
+    }
+
+    /* DMA 池需容纳订阅者处理期间到达的数据，至少一整块 */
+    uint32_t store_bytes = (uint32_t)s_cfg.num_channels * s_cfg.block_samples * SOC_ADC_DIGI_RESULT_BYTES;
+    if (store_bytes < s_dma_frame_bytes * 4) {
+        store_bytes = s_dma_frame_bytes * 4;
+    }
+    adc_continuous_handle_cfg_t handle_cfg = {
+        .max_store_buf_size = store_bytes,
+        .conv_frame_size = s_dma_frame_bytes,
+    };
+    err = adc_continuous_new_handle(&handle_cfg, &s_adc);
+    if (err != ESP_OK) goto fail;
+
+    adc_continuous_config_t dig_cfg = {
+        .pattern_num = s_cfg.num_channels,
+        .adc_pattern = pattern,
+        .sample_freq_hz = s_cfg.sample_freq_hz,
+        .conv_mode = s_cfg.unit == ADC_UNIT_1 ? ADC_CONV_SINGLE_UNIT_1 : ADC_CONV_SINGLE_UNIT_2,
+        .format = ADC_STREAM_OUTPUT_TYPE,
+    };
+    err = adc_continuous_config(s_adc, &dig_cfg);
+    if (err != ESP_OK) goto fail;
+
+    adc_continuous_evt_cbs_t cbs = {
+        .on_conv_done = adc_stream_on_conv_done,
+        .on_pool_ovf = adc_stream_on_pool_ovf,
+    };
+    err = adc_continuous_register_event_callbacks(s_adc, &cbs, NULL);
+    if (err != ESP_OK) goto fail;
+
+    s_running = true;
+    if (xTaskCreate(adc_stream_reader_task, "adc_dma", 4096, NULL, 12, &s_reader_task) != pdPASS) {
+        s_running = false;
+        err = ESP_ERR_NO_MEM;
+        goto fail;
+    }
+
+    s_conv_count = 0;
+    s_seen_overflows = 0;
+    s_anchor_us = esp_timer_get_time();
+    err = adc_continuous_start(s_adc);
+    if (err != ESP_OK) {
+        adc_stream_stop();
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Streaming %d channel(s) at %lu Hz, %u samples/block, %u blocks",
+             s_cfg.num_channels, s_cfg.sample_freq_hz, s_cfg.block_samples, s_cfg.ring_blocks);
+    return ESP_OK;
+
+fail:
+    ESP_LOGE(TAG, "Failed to start stream: %s", esp_err_to_name(err));
+    if (s_adc) {
+        adc_continuous_deinit(s_adc);
+        s_adc = NULL;
+    }
+    if (s_ring) {
+        vRingbufferDelete(s_ring);
+        s_ring = NULL;
+    }
+    if (s_exit_sem) {
+        vSemaphoreDelete(s_exit_sem);
+        s_exit_sem = NULL;
+    }
+    free(s_dma_buf);
+    s_dma_buf = NULL;
+    return err;
+}
+
+void adc_stream_stop(void)
+{
+    if (!s_running) {
+        return;
+    }
+
+    adc_continuous_stop(s_adc);
+    s_running = false;
+    xTaskNotifyGive(s_reader_task);
+
+    /* 等待读取任务退出后再释放共享资源 */
+    xSemaphoreTake(s_exit_sem, portMAX_DELAY);
+
+    adc_continuous_deinit(s_adc);
+    s_adc = NULL;
+    vRingbufferDelete(s_ring);
+    s_ring = NULL;
+    vSemaphoreDelete(s_exit_sem);
+    s_exit_sem = NULL;
+    free(s_dma_buf);
+    s_dma_buf = NULL;
+    s_reader_task = NULL;
+
+    ESP_LOGI(TAG, "Stream stopped: %lu blocks, %lu dropped, %lu DMA overflows",
+             s_stats.blocks, s_stats.dropped_blocks, s_stats.dma_overflows);
+}
+
+int adc_stream_subscribe(adc_stream_cb_t cb, void* ctx)
+{
+    if (cb == NULL) {
+        return -1;
+    }
+
+    int id = -1;
+    portENTER_CRITICAL(&s_sub_lock);
+    for (int i = 0; i < ADC_STREAM_MAX_SUBSCRIBERS; i++) {
+        if (s_subs[i].cb == NULL) {
+            s_subs[i].cb = cb;
+            s_subs[i].ctx = ctx;
+            id = i;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_sub_lock);
+
+    if (id < 0) {
+        ESP_LOGW(TAG, "No free subscriber slot");
+    }
+    return id;
+}
+
+void adc_stream_unsubscribe(int id)
+{
+    if (id < 0 || id >= ADC_STREAM_MAX_SUBSCRIBERS) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_sub_lock);
+    s_subs[id].cb = NULL;
+    s_subs[id].ctx = NULL;
+    portEXIT_CRITICAL(&s_sub_lock);
+}
+
+void adc_stream_get_stats(adc_stream_stats_t* out)
+{
+    *out = s_stats;
+}
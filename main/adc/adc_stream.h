@@ -0,0 +1,97 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+#ifndef HEALTHY_MCU_ADC_STREAM_H
+#define HEALTHY_MCU_ADC_STREAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_adc/adc_continuous.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ADC_STREAM_MAX_CHANNELS     8   // 单次扫描最多通道数
+#define ADC_STREAM_MAX_SUBSCRIBERS  4   // 最多订阅者数量
+
+    /**
+     * @brief 连续采样配置
+     *
+     * sample_freq_hz 为所有通道合计的转换速率，每通道速率 = sample_freq_hz / num_channels
+     */
+    typedef struct {
+        adc_unit_t unit;            // 需支持 DMA 连续采样（ESP32-C3 仅 ADC_UNIT_1）
+        adc_channel_t channels[ADC_STREAM_MAX_CHANNELS];
+        uint8_t num_channels;
+        adc_atten_t atten;
+        uint32_t sample_freq_hz;
+        uint16_t block_samples;     // 每个数据块中每通道的采样数
+        uint8_t ring_blocks;        // 环形缓冲可容纳的数据块数
+    } adc_stream_config_t;
+
+    /**
+     * @brief 解复用后的数据块，位于环形缓冲内部，订阅者只读
+     *
+     * 通道 i 的第 j 个采样为 samples[i * capacity + j]，有效个数为 count[i]
+     */
+    typedef struct {
+        uint32_t seq;                               // 块序号，可用于检测丢块
+        int64_t timestamp_us;                       // 块内第一个采样的时间戳
+        uint32_t period_us;                         // 单通道采样周期
+        uint8_t num_channels;
+        uint16_t capacity;                          // 每通道容量
+        adc_channel_t channel[ADC_STREAM_MAX_CHANNELS];
+        uint16_t count[ADC_STREAM_MAX_CHANNELS];
+        uint16_t samples[];
+    } adc_stream_block_t;
+
+    /**
+     * @brief 订阅回调，运行于采样读取任务；block 仅在回调期间有效
+     *
+     * 回调耗时超过 DMA 池可缓存的时长（约一块）会导致 DMA 溢出
+     */
+    typedef void (*adc_stream_cb_t)(const adc_stream_block_t* block, void* ctx);
+
+    typedef struct {
+        uint32_t blocks;            // 已提交的数据块
+        uint32_t dropped_blocks;    // 环形缓冲已满丢弃的数据块
+        uint32_t dma_overflows;     // DMA 缓冲溢出次数
+        uint32_t foreign_samples;   // 不属于配置通道的采样
+    } adc_stream_stats_t;
+
+    /**
+     * @brief 启动连续 DMA 采样
+     */
+    esp_err_t adc_stream_start(const adc_stream_config_t* config);
+
+    /**
+     * @brief 停止采样并释放资源
+     */
+    void adc_stream_stop(void);
+
+    /**
+     * @brief 注册订阅者，返回订阅 id
+     */
+    int adc_stream_subscribe(adc_stream_cb_t cb, void* ctx);
+
+    void adc_stream_unsubscribe(int id);
+
+    /**
+     * @brief 取得块内某通道的采样指针
+     */
+    static inline const uint16_t* adc_stream_channel_data(const adc_stream_block_t* block, int index)
+    {
+        return &block->samples[index * block->capacity];
+    }
+
+    void adc_stream_get_stats(adc_stream_stats_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //HEALTHY_MCU_ADC_STREAM_H
@@ -1,5 +1,4 @@
 #include <stdio.h>
-#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include "vars.h"
@@ -19,21 +18,131 @@ volatile global_data data = {
     .tiwen_status = 0,
     .tizhong_status = 0,
     .xinlv_xveyang_status = 0,
-    .xveya_status = 0
+    .xveya_status = 0,
+    .dianchi_var = 0,
+    .dianya_var = 0
 };
 
+/* 指标编号 -> 键名，下标即 iot_metric_t */
+static const char* const s_metric_keys[IOT_METRIC_MAX] = {
+    [IOT_METRIC_NONE] = NULL,
+    [IOT_METRIC_WENDU] = "wendu",
+    [IOT_METRIC_XVEYA] = "xveya",
+    [IOT_METRIC_XINLV] = "xinlv",
+    [IOT_METRIC_XVEYANG] = "xveyang",
+    [IOT_METRIC_TIZHONG] = "tizhong",
+    [IOT_METRIC_SHENGAO] = "shengao",
+    [IOT_METRIC_DIANCHI] = "dianchi",
+    [IOT_METRIC_DIANYA] = "dianya",
+    [IOT_METRIC_TEMP] = "temp",
+    [IOT_METRIC_BAUD] = "baud",
+    [IOT_METRIC_PING] = "ping",
+    [IOT_METRIC_PONG] = "pong",
+    [IOT_METRIC_FMT] = "fmt",
+    [IOT_METRIC_ERR] = "err",
+};
+
+static volatile iot_wire_format_t s_wire_format = IOT_WIRE_LEGACY;
+
+void iot_data_set_wire_format(iot_wire_format_t format)
+{
+    s_wire_format = format;
+}
+
+iot_wire_format_t iot_data_get_wire_format(void)
+{
+    return s_wire_format;
+}
+
+iot_metric_t iot_metric_from_key(const char* key)
+{
+    for (int i = IOT_METRIC_NONE + 1; i < IOT_METRIC_MAX; i++)
+    {
+        if (strcmp(s_metric_keys[i], key) == 0)
+        {
+            return (iot_metric_t)i;
+        }
+    }
+    return IOT_METRIC_NONE;
+}
+
+const char* iot_metric_to_key(iot_metric_t metric)
+{
+    return (metric > IOT_METRIC_NONE && metric < IOT_METRIC_MAX) ? s_metric_keys[metric] : NULL;
+}
+
+/**
+ * 按值类型编码 val 字段，两种格式共用
+ */
+static CborError iot_value_encode(CborEncoder* enc, const iot_data_t* data)
+{
+    const iot_value_t* v = &data->value;
+    switch (data->type)
+    {
+    case VAL_TYPE_INT:
+        return cbor_encode_int(enc, v->i);
+    case VAL_TYPE_FLOAT:
+        return cbor_encode_float(enc, v->f);
+    case VAL_TYPE_BOOL:
+        return cbor_encode_boolean(enc, v->b);
+    case VAL_TYPE_STR:
+        return cbor_encode_text_string(enc, (const char*)iot_value_data(v), v->len);
+    case VAL_TYPE_BYTE:
+        return cbor_encode_byte_string(enc, iot_value_data(v), v->len);
+    default:
+        return cbor_encode_null(enc);
+    }
+}
+
+/**
+ * 紧凑格式：[metric, val, ts, ch(, rid)]，一个浮点遥测约 14 字节
+ */
+static size_t iot_data_encode_compact(const iot_data_t* data, uint8_t* buffer, size_t buffer_size)
+{
+    CborEncoder encoder, array;
+    CborError err = CborNoError;
+    cbor_encoder_init(&encoder, buffer, buffer_size, 0);
+
+    err |= cbor_encoder_create_array(&encoder, &array, data->rid ? 5 : 4);
+
+    const iot_metric_t metric = iot_metric_from_key(data->key);
+    if (metric != IOT_METRIC_NONE)
+    {
+        err |= cbor_encode_uint(&array, metric);
+    }
+    else
+    {
+        err |= cbor_encode_text_stringz(&array, data->key);
+    }
+    err |= iot_value_encode(&array, data);
+    err |= cbor_encode_uint(&array, data->timestamp);
+    err |= cbor_encode_uint(&array, data->channel);
+    if (data->rid)
+    {
+        err |= cbor_encode_uint(&array, data->rid);
+    }
+
+    err |= cbor_encoder_close_container(&encoder, &array);
+    return err == CborNoError ? cbor_encoder_get_buffer_size(&encoder, buffer) : 0;
+}
+
 /**
- * 将 iot_data_t 结构体编码为 CBOR 格式
+ * 将 iot_data_t 结构体编码为 CBOR 格式（按当前会话格式）
  */
 size_t iot_data_encode_cbor(const iot_data_t* data, uint8_t* buffer, size_t buffer_size)
 {
-    if (!data || !buffer || !data->value) return 0;
+    if (!data || !buffer) return 0;
+
+    if (s_wire_format == IOT_WIRE_COMPACT)
+    {
+        return iot_data_encode_compact(data, buffer, buffer_size);
+    }
 
     CborEncoder encoder, map;
     cbor_encoder_init(&encoder, buffer, buffer_size, 0);
 
-    // 创建 Map，包含 6 个字段
-    cbor_encoder_create_map(&encoder, &map, 6);
+    // 创建 Map，包含 6 个字段（RPC 消息另加 rid）
+    cbor_encoder_create_map(&encoder, &map, data->rid ? 7 : 6);
 
     // 1. Device ID
     cbor_encode_text_stringz(&map, "id");
@@ -45,33 +154,7 @@ size_t iot_data_encode_cbor(const iot_data_t* data, uint8_t* buffer, size_t buff
 
     // 3. Value
     cbor_encode_text_stringz(&map, "val");
-    switch (data->type)
-    {
-    case VAL_TYPE_INT:
-        cbor_encode_int(&map, *(int*)data->value);
-        break;
-    case VAL_TYPE_FLOAT:
-        cbor_encode_float(&map, *(float*)data->value);
-        break;
-    case VAL_TYPE_BOOL:
-        cbor_encode_boolean(&map, *(bool*)data->value);
-        break;
-    case VAL_TYPE_STR:
-        cbor_encode_text_stringz(&map, (char*)data->value);
-        break;
-    case VAL_TYPE_BYTE:
-        {
-            // 注意：对于 BYTE 类型，CBOR 需要知道长度。
-            // 这里假设 data->value 指向的是以 NULL 结尾的字节流或有特定逻辑处理。
-            // 严谨做法应在结构体增加 len 字段。此处演示以字符串长度逻辑处理：
-            size_t len = strlen((char*)data->value);
-            cbor_encode_byte_string(&map, (uint8_t*)data->value, len);
-            break;
-        }
-    default:
-        cbor_encode_null(&map);
-        break;
-    }
+    iot_value_encode(&map, data);
 
     // 4. Type
     cbor_encode_text_stringz(&map, "ty");
@@ -85,87 +168,320 @@ size_t iot_data_encode_cbor(const iot_data_t* data, uint8_t* buffer, size_t buff
     cbor_encode_text_stringz(&map, "ch");
     cbor_encode_int(&map, data->channel);
 
+    // 7. Request ID（可选）
+    if (data->rid)
+    {
+        cbor_encode_text_stringz(&map, "rid");
+        cbor_encode_uint(&map, data->rid);
+    }
+
     cbor_encoder_close_container(&encoder, &map);
 
     return cbor_encoder_get_buffer_size(&encoder, buffer);
 }
 
+static iot_decode_stats_t s_decode_stats;
+
 /**
- * 将 CBOR 串解析回 iot_data_t 结构体
- * 使用 malloc 分配内存，需手动 free(out_data->value)
+ * 解码文本 / 字节串：短串复制进 sso，长串借用接收缓冲（须为定长串，才保证在缓冲中连续）
  */
-CborError iot_data_decode_cbor(const uint8_t* buffer, size_t len, iot_data_t* out_data)
+static CborError iot_string_decode(CborValue* it, bool is_text, iot_value_t* v)
 {
-    CborParser parser;
-    CborValue it, val;
-    CborError err;
-
-    err = cbor_parser_init(buffer, len, 0, &parser, &it);
+    size_t len = 0;
+    CborError err = cbor_value_calculate_string_length(it, &len);
     if (err != CborNoError) return err;
+    if (len > UINT16_MAX) return CborErrorDataTooLarge;
 
-    // 解析 ID 和 Key
-    cbor_value_map_find_value(&it, "id", &val);
-    size_t id_len = sizeof(out_data->device_id);
-    cbor_value_copy_text_string(&val, out_data->device_id, &id_len, NULL);
+    if (len < IOT_VALUE_SSO_MAX)
+    {
+        size_t n = sizeof(v->sso);
+        err = is_text
+                  ? cbor_value_copy_text_string(it, v->sso, &n, it)
+                  : cbor_value_copy_byte_string(it, (uint8_t*)v->sso, &n, it);
+        v->len = (uint16_t)n;
+        v->borrowed = false;
+        s_decode_stats.inline_values++;
+        return err;
+    }
 
-    cbor_value_map_find_value(&it, "key", &val);
-    size_t key_len = sizeof(out_data->key);
-    cbor_value_copy_text_string(&val, out_data->key, &key_len, NULL);
+    if (!cbor_value_is_length_known(it)) return CborErrorUnknownLength;
+    err = cbor_value_begin_string_iteration(it);
+    if (err != CborNoError) return err;
+    err = is_text
+              ? cbor_value_get_text_string_chunk(it, (const char**)&v->ptr, &len, it)
+              : cbor_value_get_byte_string_chunk(it, &v->ptr, &len, it);
+    if (err != CborNoError) return err;
+    v->len = (uint16_t)len;
+    v->borrowed = true;
+    s_decode_stats.borrowed_values++;
+    return cbor_value_finish_string_iteration(it);
+}
 
-    // 先解析 Type 以确定 Value 分配策略
-    cbor_value_map_find_value(&it, "ty", &val);
-    int type_tmp;
-    cbor_value_get_int(&val, &type_tmp);
-    out_data->type = (val_type_t)type_tmp;
+/**
+ * 按类型解码值，当前位置必须是与 type 匹配的 CBOR 项；成功时迭代器已前进到下一项
+ */
+static CborError iot_value_decode(CborValue* it, val_type_t type, iot_data_t* out_data)
+{
+    iot_value_t* v = &out_data->value;
+    CborError err;
 
-    // 解析 Value
-    cbor_value_map_find_value(&it, "val", &val);
-    switch (out_data->type)
+    out_data->type = type;
+    switch (type)
     {
     case VAL_TYPE_INT:
-        out_data->value = malloc(sizeof(int));
-        cbor_value_get_int(&val, (int*)out_data->value);
+        if (!cbor_value_is_integer(it)) return CborErrorIllegalType;
+        err = cbor_value_get_int_checked(it, &v->i);
         break;
     case VAL_TYPE_FLOAT:
-        out_data->value = malloc(sizeof(float));
-        cbor_value_get_float(&val, (float*)out_data->value);
+        // 主机可能以半精度、双精度或整数发送浮点量
+        if (cbor_value_is_float(it)) err = cbor_value_get_float(it, &v->f);
+        else if (cbor_value_is_double(it))
+        {
+            double d;
+            err = cbor_value_get_double(it, &d);
+            v->f = (float)d;
+        }
+        else if (cbor_value_is_half_float(it)) err = cbor_value_get_half_float_as_float(it, &v->f);
+        else if (cbor_value_is_integer(it))
+        {
+            int64_t i;
+            err = cbor_value_get_int64(it, &i);
+            v->f = (float)i;
+        }
+        else return CborErrorIllegalType;
         break;
     case VAL_TYPE_BOOL:
-        out_data->value = malloc(sizeof(bool));
-        cbor_value_get_boolean(&val, (bool*)out_data->value);
+        if (!cbor_value_is_boolean(it)) return CborErrorIllegalType;
+        err = cbor_value_get_boolean(it, &v->b);
         break;
     case VAL_TYPE_STR:
+        if (!cbor_value_is_text_string(it)) return CborErrorIllegalType;
+        return iot_string_decode(it, true, v);
+    case VAL_TYPE_BYTE:
+        if (!cbor_value_is_byte_string(it)) return CborErrorIllegalType;
+        return iot_string_decode(it, false, v);
+    default:
+        return CborErrorImproperValue;
+    }
+
+    if (err != CborNoError) return err;
+    s_decode_stats.inline_values++;
+    return cbor_value_advance_fixed(it);
+}
+
+/**
+ * 读取不超过 32 位的无符号整数并前进
+ */
+static CborError iot_uint32_decode(CborValue* it, uint32_t* out)
+{
+    uint64_t tmp;
+    if (!cbor_value_is_unsigned_integer(it)) return CborErrorIllegalType;
+    cbor_value_get_uint64(it, &tmp);
+    if (tmp > UINT32_MAX) return CborErrorDataTooLarge;
+    *out = (uint32_t)tmp;
+    return cbor_value_advance_fixed(it);
+}
+
+/**
+ * 复制定长文本字段并前进，超长返回 CborErrorDataTooLarge
+ */
+static CborError iot_text_decode(CborValue* it, char* out, size_t size)
+{
+    if (!cbor_value_is_text_string(it)) return CborErrorIllegalType;
+    // 恰好填满缓冲时 tinycbor 不写结尾 0，预留一字节并自行补上
+    size_t n = size - 1;
+    const CborError err = cbor_value_copy_text_string(it, out, &n, it);
+    if (err == CborNoError) out[n] = '\0';
+    return err == CborErrorOutOfMemory ? CborErrorDataTooLarge : err;
+}
+
+/**
+ * 解析紧凑格式数组，值类型由 CBOR 类型决定；不含设备 ID
+ */
+static CborError iot_data_decode_compact(const CborValue* array, iot_data_t* out_data)
+{
+    CborValue it;
+    CborError err;
+    uint32_t tmp;
+
+    err = cbor_value_enter_container(array, &it);
+    if (err != CborNoError) return err;
+
+    // 1. 指标编号或文本键
+    if (cbor_value_is_unsigned_integer(&it))
+    {
+        err = iot_uint32_decode(&it, &tmp);
+        const char* key = iot_metric_to_key((iot_metric_t)tmp);
+        if (err == CborNoError && key == NULL) err = CborErrorImproperValue;
+        if (err != CborNoError) return err;
+        strncpy(out_data->key, key, sizeof(out_data->key) - 1);
+        out_data->key[sizeof(out_data->key) - 1] = '\0';
+    }
+    else
+    {
+        err = iot_text_decode(&it, out_data->key, sizeof(out_data->key));
+        if (err != CborNoError) return err;
+    }
+
+    // 2. 值
+    val_type_t type;
+    switch (cbor_value_get_type(&it))
+    {
+    case CborIntegerType: type = VAL_TYPE_INT; break;
+    case CborFloatType:
+    case CborDoubleType:
+    case CborHalfFloatType: type = VAL_TYPE_FLOAT; break;
+    case CborBooleanType: type = VAL_TYPE_BOOL; break;
+    case CborTextStringType: type = VAL_TYPE_STR; break;
+    case CborByteStringType: type = VAL_TYPE_BYTE; break;
+    default: return CborErrorIllegalType;
+    }
+    err = iot_value_decode(&it, type, out_data);
+
+    // 3. 时间戳 4. 通道 5. rid（可选）
+    if (err == CborNoError) err = iot_uint32_decode(&it, &out_data->timestamp);
+    if (err == CborNoError && (err = iot_uint32_decode(&it, &tmp)) == CborNoError)
+    {
+        out_data->channel = (cannel_type_t)tmp;
+    }
+    if (err == CborNoError && !cbor_value_at_end(&it))
+    {
+        err = iot_uint32_decode(&it, &out_data->rid);
+    }
+    return err;
+}
+
+/* 旧格式的字段位，用于检测缺失与重复 */
+#define IOT_FIELD_ID    (1u << 0)
+#define IOT_FIELD_KEY   (1u << 1)
+#define IOT_FIELD_VAL   (1u << 2)
+#define IOT_FIELD_TY    (1u << 3)
+#define IOT_FIELD_TS    (1u << 4)
+#define IOT_FIELD_CH    (1u << 5)
+#define IOT_FIELD_RID   (1u << 6)
+#define IOT_FIELD_REQUIRED (IOT_FIELD_ID | IOT_FIELD_KEY | IOT_FIELD_VAL | IOT_FIELD_TY | IOT_FIELD_TS | IOT_FIELD_CH)
+
+/**
+ * 旧格式 Map 单遍解析：逐个读取键并按键分派，"val" 依赖 "ty"，先记下位置，遍历结束后再解码
+ */
+static CborError iot_data_decode_map(const CborValue* map, iot_data_t* out_data)
+{
+    CborValue it, val_at;
+    CborError err;
+    uint32_t seen = 0, tmp = 0;
+    int type = -1;
+
+    err = cbor_value_enter_container(map, &it);
+    if (err != CborNoError) return err;
+
+    while (!cbor_value_at_end(&it))
+    {
+        // 键都很短，复制到栈上比逐个 text_string_equals 少遍历
+        char key[4];
+        size_t key_len = sizeof(key) - 1;
+        if (!cbor_value_is_text_string(&it)) return CborErrorMapKeyNotString;
+        err = cbor_value_copy_text_string(&it, key, &key_len, &it);
+        if (err == CborErrorOutOfMemory)
         {
-            size_t s_len = 0;
-            cbor_value_calculate_string_length(&val, &s_len);
-            out_data->value = malloc(s_len + 1);
-            cbor_value_copy_text_string(&val, (char*)out_data->value, &s_len, NULL);
-            break;
+            // 超长的未知键：迭代器已越过键，其值在下面跳过
+            key_len = 0;
+            err = CborNoError;
         }
-    case VAL_TYPE_BYTE:
+        if (err != CborNoError) return err;
+        key[key_len] = '\0';
+
+        uint32_t field = 0;
+        if (strcmp(key, "id") == 0) field = IOT_FIELD_ID;
+        else if (strcmp(key, "key") == 0) field = IOT_FIELD_KEY;
+        else if (strcmp(key, "val") == 0) field = IOT_FIELD_VAL;
+        else if (strcmp(key, "ty") == 0) field = IOT_FIELD_TY;
+        else if (strcmp(key, "ts") == 0) field = IOT_FIELD_TS;
+        else if (strcmp(key, "ch") == 0) field = IOT_FIELD_CH;
+        else if (strcmp(key, "rid") == 0) field = IOT_FIELD_RID;
+        if (seen & field) return CborErrorDuplicateObjectKeys;
+        seen |= field;
+
+        switch (field)
         {
-            size_t b_len = 0;
-            cbor_value_get_string_length(&val, &b_len);
-            out_data->value = malloc(b_len);
-            cbor_value_copy_byte_string(&val, (uint8_t*)out_data->value, &b_len, NULL);
+        case IOT_FIELD_ID:
+            err = iot_text_decode(&it, out_data->device_id, sizeof(out_data->device_id));
+            break;
+        case IOT_FIELD_KEY:
+            err = iot_text_decode(&it, out_data->key, sizeof(out_data->key));
+            break;
+        case IOT_FIELD_VAL:
+            val_at = it;
+            err = cbor_value_advance(&it);
+            break;
+        case IOT_FIELD_TY:
+            if (!cbor_value_is_integer(&it)) return CborErrorIllegalType;
+            err = cbor_value_get_int_checked(&it, &type);
+            if (err == CborNoError && (type < VAL_TYPE_INT || type > VAL_TYPE_BYTE)) return CborErrorImproperValue;
+            if (err == CborNoError) err = cbor_value_advance_fixed(&it);
+            break;
+        case IOT_FIELD_TS:
+            err = iot_uint32_decode(&it, &out_data->timestamp);
+            break;
+        case IOT_FIELD_CH:
+            if ((err = iot_uint32_decode(&it, &tmp)) == CborNoError) out_data->channel = (cannel_type_t)tmp;
+            break;
+        case IOT_FIELD_RID:
+            err = iot_uint32_decode(&it, &out_data->rid);
+            break;
+        default:
+            // 未知字段向前兼容，直接跳过
+            err = cbor_value_advance(&it);
             break;
         }
+        if (err != CborNoError) return err;
     }
 
-    // 解析其他字段
-    cbor_value_map_find_value(&it, "ts", &val);
-    uint64_t ts_tmp;
-    cbor_value_get_uint64(&val, &ts_tmp);
-    out_data->timestamp = (uint32_t)ts_tmp;
+    if ((seen & IOT_FIELD_REQUIRED) != IOT_FIELD_REQUIRED) return CborErrorImproperValue;
+    return iot_value_decode(&val_at, (val_type_t)type, out_data);
+}
 
-    cbor_value_map_find_value(&it, "ch", &val);
-    int ch_tmp;
-    cbor_value_get_int(&val, &ch_tmp);
-    out_data->channel = (int8_t)ch_tmp;
+/**
+ * 将 CBOR 串解析回 iot_data_t 结构体，自动识别旧 Map 格式与紧凑数组格式
+ * 值内联在 out_data 中，无需释放；长串为指向 buffer 的借用视图，buffer 须在使用期间保持有效
+ */
+CborError iot_data_decode_cbor(const uint8_t* buffer, size_t len, iot_data_t* out_data)
+{
+    CborParser parser;
+    CborValue it;
+    CborError err;
+
+    memset(out_data, 0, sizeof(*out_data));
 
+    err = cbor_parser_init(buffer, len, 0, &parser, &it);
+    if (err != CborNoError) return err;
+
+    if (cbor_value_is_array(&it))
+    {
+        err = iot_data_decode_compact(&it, out_data);
+    }
+    else if (cbor_value_is_map(&it))
+    {
+        err = iot_data_decode_map(&it, out_data);
+    }
+    else
+    {
+        err = CborErrorIllegalType;
+    }
+
+    if (err != CborNoError)
+    {
+        s_decode_stats.errors++;
+        return err;
+    }
+    s_decode_stats.decoded++;
     return CborNoError;
 }
 
+void iot_data_get_decode_stats(iot_decode_stats_t* out)
+{
+    *out = s_decode_stats;
+}
+
 /**
  * 测试逻辑
  */
@@ -176,7 +492,7 @@ void test_iot_cbor()
         .device_id = "DEV-ESP32-001",
         .key = "temp",
         .type = VAL_TYPE_FLOAT,
-        .value = &current_temp, // 指向局部或全局变量
+        .value = iot_value_float(current_temp),
         .channel = CANNEL_PROPERTY,
         .timestamp = 1705324800
     };
@@ -192,10 +508,7 @@ void test_iot_cbor()
                recv_node.device_id,
                recv_node.key,
                recv_node.type,
-               *(float*)recv_node.value,
+               recv_node.value.f,
                recv_node.channel);
-
-        // 重要：释放解码时动态分配的内存
-        free(recv_node.value);
     }
 }
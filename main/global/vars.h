@@ -4,7 +4,9 @@
 
 #ifndef HEALTHY_MCU_VARS_H
 #define HEALTHY_MCU_VARS_H
+#include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "cbor.h"
 
@@ -26,14 +28,97 @@ typedef enum
     CANNEL_CONFIG = 4,
 } cannel_type_t;
 
+/*
+ * 线路格式：
+ *   LEGACY  文本键 Map {"id","key","val","ty","ts","ch"[,"rid"]}，每条都带完整设备 ID
+ *   COMPACT 定长数组 [metric, val, ts, ch(, rid)]，metric 为指标编号（表外的键仍发文本），
+ *           值类型由 CBOR 类型本身区分；设备 ID 只在会话协商时以 LEGACY 格式发送一次
+ * 解码器按顶层是 Map 还是数组自动识别，两种格式始终都能接收。
+ */
+typedef enum
+{
+    IOT_WIRE_LEGACY = 0,
+    IOT_WIRE_COMPACT = 1,
+} iot_wire_format_t;
+
+/* 紧凑格式的指标编号，新增只能追加在末尾 */
+typedef enum
+{
+    IOT_METRIC_NONE = 0,
+    IOT_METRIC_WENDU,
+    IOT_METRIC_XVEYA,
+    IOT_METRIC_XINLV,
+    IOT_METRIC_XVEYANG,
+    IOT_METRIC_TIZHONG,
+    IOT_METRIC_SHENGAO,
+    IOT_METRIC_DIANCHI,
+    IOT_METRIC_DIANYA,
+    IOT_METRIC_TEMP,
+    IOT_METRIC_BAUD,
+    IOT_METRIC_PING,
+    IOT_METRIC_PONG,
+    IOT_METRIC_FMT,
+    IOT_METRIC_ERR,
+    IOT_METRIC_MAX,
+} iot_metric_t;
+
+#define IOT_VALUE_SSO_MAX   16      // 内联短字符串容量（含结尾 '\0'）
+
+/*
+ * 值直接内联在 iot_data_t 中，由 iot_data_t.type 标记有效成员，收发都不再分配堆内存：
+ *   INT / FLOAT / BOOL  存于 i / f / b
+ *   STR / BYTE          不超过 IOT_VALUE_SSO_MAX - 1 字节时复制到 sso（STR 以 '\0' 结尾）；
+ *                       更长时 borrowed 为 true，ptr 借用外部内存且不以 '\0' 结尾。
+ *                       解码得到的借用视图指向接收帧，只在接收回调返回前有效。
+ */
+typedef struct
+{
+    union
+    {
+        int i;
+        float f;
+        bool b;
+        char sso[IOT_VALUE_SSO_MAX];
+        const uint8_t* ptr;
+    };
+    uint16_t len;           // STR / BYTE 的字节数（不含 '\0'）
+    bool borrowed;          // STR / BYTE 是否为借用视图
+} iot_value_t;
+
+static inline iot_value_t iot_value_int(int v) { return (iot_value_t){.i = v}; }
+static inline iot_value_t iot_value_float(float v) { return (iot_value_t){.f = v}; }
+static inline iot_value_t iot_value_bool(bool v) { return (iot_value_t){.b = v}; }
+
+/**
+ * @brief 借用字节串（编码时使用，调用者保证 data 在编码期间有效）
+ */
+static inline iot_value_t iot_value_bytes(const uint8_t* data, size_t len)
+{
+    return (iot_value_t){.ptr = data, .len = (uint16_t)len, .borrowed = true};
+}
+
+static inline iot_value_t iot_value_str(const char* s)
+{
+    return iot_value_bytes((const uint8_t*)s, strlen(s));
+}
+
+/**
+ * @brief STR / BYTE 的数据起始地址，长度见 len
+ */
+static inline const uint8_t* iot_value_data(const iot_value_t* v)
+{
+    return v->borrowed ? v->ptr : (const uint8_t*)v->sso;
+}
+
 typedef struct
 {
     char device_id[18];
     char key[14];
-    void* value;
+    iot_value_t value;
     val_type_t type;
     cannel_type_t channel;
     uint32_t timestamp;
+    uint32_t rid;           // RPC 请求 ID，0 表示非 RPC 消息（不编码）
 } iot_data_t;
 
 
@@ -53,10 +138,35 @@ typedef struct
     int lvdeng_status;
     int hongdeng_status;
     int fengmingqi_status;
+    float dianchi_var;      // 电池剩余电量 %
+    int dianya_var;         // 电池电压 mV
 } global_data;
 
 extern volatile global_data data;
 
+/**
+ * @brief 设置本会话的发送格式（接收始终兼容两种格式）
+ */
+void iot_data_set_wire_format(iot_wire_format_t format);
+iot_wire_format_t iot_data_get_wire_format(void);
+
+/**
+ * @brief 键名与指标编号互查，表外的键返回 IOT_METRIC_NONE / NULL
+ */
+iot_metric_t iot_metric_from_key(const char* key);
+const char* iot_metric_to_key(iot_metric_t metric);
+
+/* 解码统计：值要么内联要么借用，稳态收包不分配堆内存 */
+typedef struct
+{
+    uint32_t decoded;
+    uint32_t errors;
+    uint32_t inline_values;     // 标量或复制进 sso 的短串
+    uint32_t borrowed_values;   // 借用接收帧的长串
+} iot_decode_stats_t;
+
+void iot_data_get_decode_stats(iot_decode_stats_t* out);
+
 size_t iot_data_encode_cbor(const iot_data_t* data, uint8_t* buffer, size_t buffer_size);
 CborError iot_data_decode_cbor(const uint8_t* buffer, size_t len, iot_data_t* out_data);
 
@@ -29,6 +29,16 @@ void hx710b_init(hx710b_t* dev)
     gpio_set_level(dev->sck_pin, 0);
 }
 
+bool hx710b_is_ready(hx710b_t* dev)
+{
+    return gpio_get_level(dev->dout_pin) == 0;
+}
+
+float hx710b_sample_rate(const hx710b_t* dev)
+{
+    return dev->rate == HX710B_RATE_40HZ ? 40.0f : 10.0f;
+}
+
 /**
  * HX710B 24bit 读取
  */
@@ -54,11 +64,15 @@ int32_t hx710b_read(hx710b_t* dev)
         hx710b_delay();
     }
 
-    /* 第 25 个脉冲，选择通道 & 增益（HX710B 固定） */
-    gpio_set_level(dev->sck_pin, 1);
-    hx710b_delay();
-    gpio_set_level(dev->sck_pin, 0);
-    hx710b_delay();
+    /* 第 25~27 个脉冲，选择下一次转换的输入与速率 */
+    int extra = dev->rate == HX710B_RATE_40HZ ? 3 : 1;
+    for (int i = 0; i < extra; i++)
+    {
+        gpio_set_level(dev->sck_pin, 1);
+        hx710b_delay();
+        gpio_set_level(dev->sck_pin, 0);
+        hx710b_delay();
+    }
 
     /* 符号扩展（24 位补码） */
     if (value & 0x800000)
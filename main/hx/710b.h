@@ -3,10 +3,22 @@
 
 #include "driver/gpio.h"
 #include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * 输出速率选择（由每次读取的时钟脉冲数决定）
+ * 25 个脉冲：差分输入 10Hz
+ * 27 个脉冲：差分输入 40Hz
+ */
+typedef enum {
+    HX710B_RATE_10HZ = 0,
+    HX710B_RATE_40HZ = 1,
+} hx710b_rate_t;
 
 typedef struct {
     gpio_num_t sck_pin;
     gpio_num_t dout_pin;
+    hx710b_rate_t rate;
 } hx710b_t;
 
 /**
@@ -14,6 +26,16 @@ typedef struct {
  */
 void hx710b_init(hx710b_t *dev);
 
+/**
+ * 数据是否就绪（DOUT 为低）
+ */
+bool hx710b_is_ready(hx710b_t *dev);
+
+/**
+ * 获取当前配置对应的采样率（Hz）
+ */
+float hx710b_sample_rate(const hx710b_t *dev);
+
 /**
  * 读取 24 位原始 ADC 数据（有符号）
  */
@@ -10,6 +10,7 @@
 
 #include "esp_check.h"
 #include "myi2c.h"
+#include "power.h"
 #include "driver/gpio.h"
 #include "driver/i2c_master.h"
 
@@ -34,8 +35,8 @@ static esp_err_t max30102_write(
 
     ESP_LOGI("MAX30102", "Write: %02x %02x", reg_addr, data);
 
-    return i2c_master_transmit(
-        sens->dev_handle,
+    return i2c_bus_write(
+        sens->dev,
         buf,
         sizeof(buf),
         I2C_MASTER_TIMEOUT_MS
@@ -57,8 +58,8 @@ static esp_err_t max30102_read(
 
     max30102_dev_t* sens = (max30102_dev_t*)sensor;
 
-    return i2c_master_transmit_receive(
-        sens->dev_handle,
+    return i2c_bus_write_read(
+        sens->dev,
         &reg_addr,
         1,
         data,
@@ -71,7 +72,6 @@ static esp_err_t max30102_read(
 /* ================= 设备生命周期 ================= */
 
 max30102_handle_t max30102_create(
-    i2c_master_bus_handle_t bus,
     uint16_t dev_addr,
     gpio_num_t int_pin
 )
@@ -83,19 +83,14 @@ max30102_handle_t max30102_create(
         return NULL;
     }
 
-    sensor->bus_handle = bus;
     sensor->dev_address = dev_addr;
     sensor->int_pin = int_pin;
 
-    i2c_device_config_t dev_cfg = {
-        .device_address = dev_addr,
-        .scl_speed_hz = 400000,
-    };
-
-    esp_err_t ret = i2c_master_bus_add_device(
-        bus,
-        &dev_cfg,
-        &sensor->dev_handle
+    esp_err_t ret = i2c_bus_add_device(
+        "max30102",
+        dev_addr,
+        400000,
+        &sensor->dev
     );
 
     if (ret != ESP_OK)
@@ -118,10 +113,11 @@ void max30102_delete(max30102_handle_t sensor)
 
     max30102_dev_t* sens = (max30102_dev_t*)sensor;
 
-    if (sens->dev_handle)
+    if (sens->dev)
     {
-        i2c_master_bus_rm_device(sens->dev_handle);
+        i2c_bus_remove_device(sens->dev);
     }
+    power_set_active(POWER_SUBSYS_MAX30102_LED, false);
 
     free(sens);
 }
@@ -130,7 +126,13 @@ void max30102_delete(max30102_handle_t sensor)
 
 esp_err_t max30102_reset(max30102_handle_t sensor)
 {
-    return max30102_write(sensor, REG_MODE_CONFIG, 0x40);
+    esp_err_t ret = max30102_write(sensor, REG_MODE_CONFIG, 0x40);
+    if (ret == ESP_OK)
+    {
+        // 复位后 LED 电流寄存器归零
+        power_set_active(POWER_SUBSYS_MAX30102_LED, false);
+    }
+    return ret;
 }
 
 static esp_err_t write_sequence(
@@ -193,12 +195,15 @@ esp_err_t max30102_config(max30102_handle_t sensor)
 
     ESP_RETURN_ON_ERROR(max30102_reset(sensor), TAG, "Reset failed");
 
-    return write_sequence(
+    ESP_RETURN_ON_ERROR(write_sequence(
         sensor,
         regs,
         vals,
         sizeof(regs) / sizeof(regs[0])
-    );
+    ), TAG, "Config failed");
+
+    power_set_active(POWER_SUBSYS_MAX30102_LED, true);
+    return ESP_OK;
 }
 
 /* ================= FIFO / 温度 ================= */
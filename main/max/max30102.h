@@ -11,6 +11,7 @@
 #include "driver/i2c_types.h"
 #include "soc/gpio_num.h"
 #include "esp_err.h"
+#include "myi2c.h"
 
 #define MAX30102_Device_address 0x57 // 8位地址表示
 
@@ -39,8 +40,7 @@
 #define REG_PART_ID 0xFF
 
 typedef struct {
-    i2c_master_bus_handle_t bus_handle;
-    i2c_master_dev_handle_t dev_handle;
+    i2c_bus_dev_handle_t dev;
     uint16_t dev_address;
     gpio_num_t int_pin;
 } max30102_dev_t;
@@ -50,7 +50,6 @@ typedef struct {
 typedef void* max30102_handle_t;
 
 max30102_handle_t max30102_create(
-    i2c_master_bus_handle_t bus,
     uint16_t dev_addr,
     gpio_num_t int_pin
 );
@@ -7,22 +7,98 @@
  */
 
 #include "myi2c.h"
+#include <string.h>
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "driver/gpio.h"
 #include "driver/i2c_master.h"
 #include "driver/i2c_types.h"
+#include "esp_rom_gpio.h"
+#include "soc/gpio_sig_map.h"
+#include "soc/i2c_periph.h"
 
 static const char *TAG = "MY_I2C";
 
 /* 全局 I2C Bus 句柄 —— 等价于老版 I2C_NUM_x */
 i2c_master_bus_handle_t g_i2c_bus = NULL;
 
+/*
+ * 总线注册表：C3 只有一个 I2C 控制器，所有传感器共用 g_i2c_bus，
+ * 由这里统一分配设备句柄、串行化事务并统计占用率。
+ */
+static SemaphoreHandle_t s_bus_mutex = NULL;
+static i2c_bus_device_t s_devices[I2C_BUS_MAX_DEVICES];
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t s_window_start = 0;
+static uint64_t s_window_busy_us = 0;
+static uint32_t s_window_xfers = 0;
+static uint32_t s_recovery_count = 0;
+
+/*
+ * 惰性初始化状态：多个驱动任务可能同时首次使用总线、异步队列或发现服务，
+ * 由同一把锁保证各自只初始化一次
+ */
+typedef enum { I2C_INIT_NONE, I2C_INIT_RUNNING, I2C_INIT_DONE } i2c_init_state_t;
+static portMUX_TYPE s_init_lock = portMUX_INITIALIZER_UNLOCKED;
+static i2c_init_state_t s_init_state = I2C_INIT_NONE;
+static i2c_init_state_t s_async_state = I2C_INIT_NONE;
+static i2c_init_state_t s_discovery_state = I2C_INIT_NONE;
+
+/**
+ * @description: 抢占初始化权；其他任务正在初始化时等待其结束
+ * @return true 调用方负责初始化并须调用 i2c_init_finish；false 已初始化完成
+ */
+static bool i2c_init_claim(i2c_init_state_t *state)
+{
+    while (1) {
+        portENTER_CRITICAL(&s_init_lock);
+        const i2c_init_state_t cur = *state;
+        if (cur == I2C_INIT_NONE) {
+            *state = I2C_INIT_RUNNING;
+        }
+        portEXIT_CRITICAL(&s_init_lock);
+
+        if (cur != I2C_INIT_RUNNING) {
+            return cur == I2C_INIT_NONE;
+        }
+        vTaskDelay(1);
+    }
+}
+
+/* 失败时回到未初始化，允许之后重试 */
+static void i2c_init_finish(i2c_init_state_t *state, bool ok)
+{
+    portENTER_CRITICAL(&s_init_lock);
+    *state = ok ? I2C_INIT_DONE : I2C_INIT_NONE;
+    portEXIT_CRITICAL(&s_init_lock);
+}
+
+#define I2C_BUS_QUARANTINE_MIN_MS 100   // 首次隔离时长，之后每次翻倍
+#define I2C_BUS_QUARANTINE_MAX_MS 5000
+
+static const uint32_t s_lat_bounds_us[I2C_BUS_LAT_BUCKETS - 1] = {
+    100, 200, 500, 1000, 2000, 5000, 10000,
+};
+
+/*
+ * 异步事务：请求进入队列，由单个工作任务依次在总线上执行并回调。
+ * 未使用 IDF 驱动自带的 trans_queue_depth 异步模式 —— 该模式对整条总线生效，
+ * 会让现有同步驱动（栈上缓冲区）失效，且忽略事务超时。
+ */
+static QueueHandle_t s_async_queue = NULL;
+static TaskHandle_t s_async_task = NULL;
+
 /**
  * @description: 初始化 I2C Master（等价于 i2c_param_config + i2c_driver_install）
  */
 esp_err_t i2c_master_init(void)
 {
-    if (g_i2c_bus != NULL) {
-        ESP_LOGW(TAG, "I2C bus already initialized");
+    if (!i2c_init_claim(&s_init_state)) {
+        ESP_LOGD(TAG, "I2C bus already initialized");
         return ESP_OK;
     }
 
@@ -35,16 +111,74 @@ esp_err_t i2c_master_init(void)
         .flags.enable_internal_pullup = true,
     };
 
-    esp_err_t err = i2c_new_master_bus(&bus_cfg, &g_i2c_bus);
+    s_bus_mutex = xSemaphoreCreateRecursiveMutex();
+    if (s_bus_mutex == NULL) {
+        i2c_init_finish(&s_init_state, false);
+        return ESP_ERR_NO_MEM;
+    }
+
+    i2c_master_bus_handle_t bus = NULL;
+    esp_err_t err = i2c_new_master_bus(&bus_cfg, &bus);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "i2c_new_master_bus failed: %s", esp_err_to_name(err));
+        vSemaphoreDelete(s_bus_mutex);
+        s_bus_mutex = NULL;
+        i2c_init_finish(&s_init_state, false);
         return err;
     }
+    s_window_start = esp_timer_get_time();
+
+    /* 互斥锁与统计窗口就绪后再发布句柄，其他任务看到 g_i2c_bus 即可直接使用 */
+    g_i2c_bus = bus;
+    i2c_init_finish(&s_init_state, true);
 
     ESP_LOGI(TAG, "I2C master initialized");
     return ESP_OK;
 }
 
+static void i2c_async_task(void *arg)
+{
+    i2c_bus_async_req_t req;
+
+    while (1) {
+        if (xQueueReceive(s_async_queue, &req, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        int timeout = req.timeout_ms > 0 ? req.timeout_ms : I2C_BUS_ASYNC_TIMEOUT_MS;
+        esp_err_t err = i2c_bus_write_read(req.dev, req.tx, req.tx_len, req.rx, req.rx_len, timeout);
+
+        if (req.cb) {
+            req.cb(req.dev, err, req.user_ctx);
+        }
+        if (req.notify_task) {
+            xTaskNotifyGive(req.notify_task);
+        }
+    }
+}
+
+static esp_err_t i2c_async_start(void)
+{
+    if (!i2c_init_claim(&s_async_state)) {
+        return ESP_OK;
+    }
+
+    s_async_queue = xQueueCreate(I2C_BUS_ASYNC_QUEUE_LEN, sizeof(i2c_bus_async_req_t));
+    if (s_async_queue == NULL) {
+        i2c_init_finish(&s_async_state, false);
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(i2c_async_task, "i2c_async", 3072, NULL, 10, &s_async_task) != pdPASS) {
+        vQueueDelete(s_async_queue);
+        s_async_queue = NULL;
+        i2c_init_finish(&s_async_state, false);
+        return ESP_ERR_NO_MEM;
+    }
+    i2c_init_finish(&s_async_state, true);
+    return ESP_OK;
+}
+
 /**
  * @description: 获取 I2C bus 句柄（供传感器驱动使用）
  */
@@ -53,13 +187,533 @@ i2c_master_bus_handle_t my_i2c_get_bus(void)
     return g_i2c_bus;
 }
 
+/**
+ * @description: 在共享总线上注册设备
+ */
+esp_err_t i2c_bus_add_device(const char *name, uint16_t address, uint32_t scl_speed_hz, i2c_bus_dev_handle_t *out)
+{
+    if (out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = ESP_OK;
+    if (g_i2c_bus == NULL) {
+        err = i2c_master_init();
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    i2c_bus_lock(-1);
+
+    i2c_bus_device_t *slot = NULL;
+    for (int i = 0; i < I2C_BUS_MAX_DEVICES; i++) {
+        if (s_devices[i].handle != NULL && s_devices[i].address == address) {
+            ESP_LOGW(TAG, "Device 0x%02X already registered as %s", address, s_devices[i].name);
+            *out = &s_devices[i];
+            i2c_bus_unlock();
+            return ESP_OK;
+        }
+        if (slot == NULL && s_devices[i].handle == NULL) {
+            slot = &s_devices[i];
+        }
+    }
+
+    if (slot == NULL) {
+        ESP_LOGE(TAG, "I2C device table full");
+        i2c_bus_unlock();
+        return ESP_ERR_NO_MEM;
+    }
+
+    i2c_device_config_t dev_cfg = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = address,
+        .scl_speed_hz = scl_speed_hz,
+    };
+
+    err = i2c_master_bus_add_device(g_i2c_bus, &dev_cfg, &slot->handle);
+    if (err == ESP_OK) {
+        slot->name = name;
+        slot->address = address;
+        slot->scl_speed_hz = scl_speed_hz;
+        slot->deadline_ms = I2C_BUS_DEFAULT_DEADLINE_MS;
+        slot->xfer_count = 0;
+        slot->error_count = 0;
+        slot->timeout_count = 0;
+        slot->skipped_count = 0;
+        slot->lock_timeout_count = 0;
+        slot->busy_us = 0;
+        slot->max_latency_us = 0;
+        memset(slot->latency_hist, 0, sizeof(slot->latency_hist));
+        slot->consecutive_fails = 0;
+        slot->quarantine_until = 0;
+        *out = slot;
+        ESP_LOGI(TAG, "Registered %s at 0x%02X (%lu Hz)", name, address, scl_speed_hz);
+    } else {
+        slot->handle = NULL;
+        ESP_LOGE(TAG, "Add %s failed: %s", name, esp_err_to_name(err));
+    }
+
+    i2c_bus_unlock();
+    return err;
+}
+
+esp_err_t i2c_bus_remove_device(i2c_bus_dev_handle_t dev)
+{
+    if (dev == NULL || dev->handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    i2c_bus_lock(-1);
+    esp_err_t err = i2c_master_bus_rm_device(dev->handle);
+    dev->handle = NULL;
+    i2c_bus_unlock();
+    return err;
+}
+
+esp_err_t i2c_bus_lock(int timeout_ms)
+{
+    if (s_bus_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    TickType_t ticks = timeout_ms < 0 ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    return xSemaphoreTakeRecursive(s_bus_mutex, ticks) == pdTRUE ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+void i2c_bus_unlock(void)
+{
+    xSemaphoreGiveRecursive(s_bus_mutex);
+}
+
+esp_err_t i2c_bus_set_deadline(i2c_bus_dev_handle_t dev, int deadline_ms)
+{
+    if (dev == NULL || deadline_ms <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    dev->deadline_ms = deadline_ms;
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_recover(void)
+{
+    if (g_i2c_bus == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    i2c_bus_lock(-1);
+    /* i2c_master_bus_reset 会输出至多 9 个 SCL 脉冲释放 SDA，再复位硬件状态机 */
+    esp_err_t err = i2c_master_bus_reset(g_i2c_bus);
+    s_recovery_count++;
+    i2c_bus_unlock();
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Bus recovery failed: %s", esp_err_to_name(err));
+    } else {
+        ESP_LOGW(TAG, "Bus recovered (%lu)", s_recovery_count);
+    }
+    return err;
+}
+
+static void i2c_bus_record(i2c_bus_dev_handle_t dev, esp_err_t err, uint32_t elapsed, int64_t now)
+{
+    int bucket = 0;
+    while (bucket < I2C_BUS_LAT_BUCKETS - 1 && elapsed >= s_lat_bounds_us[bucket]) {
+        bucket++;
+    }
+
+    dev->xfer_count++;
+    dev->busy_us += elapsed;
+    dev->latency_hist[bucket]++;
+    if (elapsed > dev->max_latency_us) {
+        dev->max_latency_us = elapsed;
+    }
+
+    if (err == ESP_OK) {
+        dev->consecutive_fails = 0;
+        return;
+    }
+
+    if (err == ESP_ERR_TIMEOUT) {
+        dev->timeout_count++;
+    } else {
+        dev->error_count++;
+    }
+
+    /* 连续失败的设备进入指数退避隔离，只降级它自己的读数 */
+    if (++dev->consecutive_fails >= I2C_BUS_FAIL_QUARANTINE) {
+        uint32_t shift = dev->consecutive_fails - I2C_BUS_FAIL_QUARANTINE;
+        uint32_t ms = I2C_BUS_QUARANTINE_MIN_MS << (shift > 6 ? 6 : shift);
+        if (ms > I2C_BUS_QUARANTINE_MAX_MS) {
+            ms = I2C_BUS_QUARANTINE_MAX_MS;
+        }
+        dev->quarantine_until = now + (int64_t)ms * 1000;
+        ESP_LOGW(TAG, "%s failing (%s), quarantined for %lu ms", dev->name, esp_err_to_name(err), ms);
+    }
+}
+
+/* 执行一次事务：加锁、计时、统计、故障恢复 */
+static esp_err_t i2c_bus_xfer(i2c_bus_dev_handle_t dev, const uint8_t *tx, size_t tx_len,
+                              uint8_t *rx, size_t rx_len, int timeout_ms)
+{
+    if (dev == NULL || dev->handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (dev->quarantine_until && esp_timer_get_time() < dev->quarantine_until) {
+        portENTER_CRITICAL(&s_stats_lock);
+        dev->skipped_count++;
+        portEXIT_CRITICAL(&s_stats_lock);
+        return I2C_BUS_ERR_QUARANTINED;
+    }
+
+    /* 截止时间：调用方超时与设备截止时间取较小值，-1 不再意味着无限等待 */
+    if (timeout_ms < 0 || timeout_ms > dev->deadline_ms) {
+        timeout_ms = dev->deadline_ms;
+    }
+
+    /*
+     * 等锁使用独立预算：截止时间只约束本设备的传输，不能因为其他设备
+     * 正占用总线（如 5ms 截止时间的设备排在一次 10ms 事务之后）就判定失败。
+     * 等锁超时不计入连续失败，它不是设备故障。
+     */
+    esp_err_t err = i2c_bus_lock(I2C_BUS_LOCK_WAIT_MS);
+    if (err != ESP_OK) {
+        portENTER_CRITICAL(&s_stats_lock);
+        dev->lock_timeout_count++;
+        portEXIT_CRITICAL(&s_stats_lock);
+        ESP_LOGD(TAG, "%s: bus busy, lock wait timed out", dev->name);
+        return err;
+    }
+
+    int64_t start = esp_timer_get_time();
+    if (tx_len && rx_len) {
+        err = i2c_master_transmit_receive(dev->handle, tx, tx_len, rx, rx_len, timeout_ms);
+    } else if (tx_len) {
+        err = i2c_master_transmit(dev->handle, tx, tx_len, timeout_ms);
+    } else {
+        err = i2c_master_receive(dev->handle, rx, rx_len, timeout_ms);
+    }
+    int64_t now = esp_timer_get_time();
+    uint32_t elapsed = (uint32_t)(now - start);
+
+    i2c_bus_record(dev, err, elapsed, now);
+
+    portENTER_CRITICAL(&s_stats_lock);
+    s_window_busy_us += elapsed;
+    s_window_xfers++;
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    /* 超时通常意味着 SDA 被从机拉住，立即恢复总线避免影响其他设备 */
+    if (err == ESP_ERR_TIMEOUT) {
+        i2c_bus_recover();
+    }
+
+    i2c_bus_unlock();
+    return err;
+}
+
+esp_err_t i2c_bus_write(i2c_bus_dev_handle_t dev, const uint8_t *data, size_t len, int timeout_ms)
+{
+    return i2c_bus_xfer(dev, data, len, NULL, 0, timeout_ms);
+}
+
+esp_err_t i2c_bus_read(i2c_bus_dev_handle_t dev, uint8_t *data, size_t len, int timeout_ms)
+{
+    return i2c_bus_xfer(dev, NULL, 0, data, len, timeout_ms);
+}
+
+esp_err_t i2c_bus_write_read(i2c_bus_dev_handle_t dev, const uint8_t *tx, size_t tx_len,
+                             uint8_t *rx, size_t rx_len, int timeout_ms)
+{
+    return i2c_bus_xfer(dev, tx, tx_len, rx, rx_len, timeout_ms);
+}
+
+void i2c_bus_get_stats(i2c_bus_stats_t *out)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&s_stats_lock);
+    out->window_us = (uint64_t)(now - s_window_start);
+    out->busy_us = s_window_busy_us;
+    out->xfer_count = s_window_xfers;
+    s_window_start = now;
+    s_window_busy_us = 0;
+    s_window_xfers = 0;
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    out->recovery_count = s_recovery_count;
+    out->utilization = out->window_us ? (float)out->busy_us / (float)out->window_us : 0;
+}
+
+void i2c_bus_log_stats(void)
+{
+    i2c_bus_stats_t stats;
+    i2c_bus_get_stats(&stats);
+
+    ESP_LOGI(TAG, "Bus utilization %.1f%% (%lu xfers in %llu ms, %lu recoveries)",
+             stats.utilization * 100.0f, stats.xfer_count, stats.window_us / 1000, stats.recovery_count);
+
+    for (int i = 0; i < I2C_BUS_MAX_DEVICES; i++) {
+        const i2c_bus_device_t *dev = &s_devices[i];
+        if (dev->handle == NULL) {
+            continue;
+        }
+        ESP_LOGI(TAG, "  %-10s 0x%02X xfers=%lu errors=%lu timeouts=%lu skipped=%lu lock_to=%lu avg=%lluus max=%luus",
+                 dev->name, dev->address, dev->xfer_count, dev->error_count, dev->timeout_count,
+                 dev->skipped_count, dev->lock_timeout_count, dev->xfer_count ? dev->busy_us / dev->xfer_count : 0,
+                 dev->max_latency_us);
+        ESP_LOGI(TAG, "  %-10s hist <100:%lu <200:%lu <500:%lu <1k:%lu <2k:%lu <5k:%lu <10k:%lu >=10k:%lu",
+                 "", dev->latency_hist[0], dev->latency_hist[1], dev->latency_hist[2], dev->latency_hist[3],
+                 dev->latency_hist[4], dev->latency_hist[5], dev->latency_hist[6], dev->latency_hist[7]);
+    }
+}
+
+esp_err_t i2c_bus_submit(const i2c_bus_async_req_t *req)
+{
+    if (req == NULL || req->dev == NULL || req->tx_len > I2C_BUS_ASYNC_TX_MAX ||
+        (req->rx_len && req->rx == NULL) || (req->tx_len == 0 && req->rx_len == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = i2c_async_start();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    if (xQueueSend(s_async_queue, req, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Async queue full, %s request rejected", req->dev->name);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_write_read_async(i2c_bus_dev_handle_t dev, const uint8_t *tx, size_t tx_len,
+                                   uint8_t *rx, size_t rx_len, i2c_bus_done_cb_t cb, void *user_ctx)
+{
+    if (tx_len > I2C_BUS_ASYNC_TX_MAX) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    i2c_bus_async_req_t req = {
+        .dev = dev,
+        .tx_len = tx_len,
+        .rx = rx,
+        .rx_len = rx_len,
+        .cb = cb,
+        .user_ctx = user_ctx,
+    };
+    if (tx_len) {
+        memcpy(req.tx, tx, tx_len);
+    }
+    return i2c_bus_submit(&req);
+}
+
+esp_err_t i2c_bus_write_async(i2c_bus_dev_handle_t dev, const uint8_t *data, size_t len,
+                              i2c_bus_done_cb_t cb, void *user_ctx)
+{
+    return i2c_bus_write_read_async(dev, data, len, NULL, 0, cb, user_ctx);
+}
+
+uint32_t i2c_bus_async_pending(void)
+{
+    return s_async_queue ? uxQueueMessagesWaiting(s_async_queue) : 0;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  设备发现                                    */
+/* -------------------------------------------------------------------------- */
+
+#define I2C_DISCOVERY_NVS_NS "i2c"
+#define I2C_DISCOVERY_NVS_KEY "present"
+#define I2C_PROBE_TIMEOUT_MS 5
+
+/* 只探测本机可能挂载的传感器地址 */
+static const struct {
+    uint16_t address;
+    const char *name;
+} s_known_devices[] = {
+    {0x57, "max30102"},
+    {0x5A, "mlx90614"},
+};
+
+#define I2C_KNOWN_COUNT (sizeof(s_known_devices) / sizeof(s_known_devices[0]))
+
+static volatile uint32_t s_present_mask = 0;
+static volatile uint32_t s_sleeping_mask = 0;    /* 休眠中的设备不响应地址，跳过探测 */
+static i2c_hotplug_cb_t s_hotplug_cb = NULL;
+static void *s_hotplug_ctx = NULL;
+static TaskHandle_t s_discovery_task = NULL;
+
+/* 返回 ESP_OK 表示应答，ESP_ERR_NOT_FOUND 表示 NACK，其余（含等锁超时）表示状态未知 */
+static esp_err_t i2c_probe_locked(uint16_t address)
+{
+    /* 等锁与普通事务使用同一预算；5ms 在 100Hz tick 下为 0，会变成非阻塞尝试 */
+    esp_err_t err = i2c_bus_lock(I2C_BUS_LOCK_WAIT_MS);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = i2c_master_probe(g_i2c_bus, address, I2C_PROBE_TIMEOUT_MS);
+    i2c_bus_unlock();
+    return err;
+}
+
+static uint32_t i2c_discovery_probe_all(void)
+{
+    uint32_t mask = 0;
+    for (int i = 0; i < I2C_KNOWN_COUNT; i++) {
+        const uint32_t bit = 1u << i;
+        if (s_sleeping_mask & bit) {
+            mask |= s_present_mask & bit;
+            continue;
+        }
+
+        esp_err_t err = i2c_probe_locked(s_known_devices[i].address);
+        if (err == ESP_OK) {
+            mask |= bit;
+        } else if (err != ESP_ERR_NOT_FOUND) {
+            /* 总线繁忙或超时无法判断，沿用上次结果，只有 NACK 才判定为拔出 */
+            mask |= s_present_mask & bit;
+            ESP_LOGD(TAG, "Probe %s inconclusive: %s", s_known_devices[i].name, esp_err_to_name(err));
+        }
+    }
+    return mask;
+}
+
+static void i2c_discovery_save(uint32_t mask)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(I2C_DISCOVERY_NVS_NS, NVS_READWRITE, &nvs) != ESP_OK) {
+        return;
+    }
+    nvs_set_u32(nvs, I2C_DISCOVERY_NVS_KEY, mask);
+    nvs_commit(nvs);
+    nvs_close(nvs);
+}
+
+static uint32_t i2c_discovery_load(void)
+{
+    nvs_handle_t nvs;
+    uint32_t mask = 0;
+    if (nvs_open(I2C_DISCOVERY_NVS_NS, NVS_READONLY, &nvs) == ESP_OK) {
+        nvs_get_u32(nvs, I2C_DISCOVERY_NVS_KEY, &mask);
+        nvs_close(nvs);
+    }
+    return mask;
+}
+
+static void i2c_discovery_task(void *arg)
+{
+    while (1) {
+        uint32_t mask = i2c_discovery_probe_all();
+        uint32_t changed = mask ^ s_present_mask;
+
+        if (changed) {
+            s_present_mask = mask;
+            /* 仅在变化时写 NVS，避免磨损 */
+            i2c_discovery_save(mask);
+
+            for (int i = 0; i < I2C_KNOWN_COUNT; i++) {
+                if (!(changed & (1u << i))) {
+                    continue;
+                }
+                bool present = (mask & (1u << i)) != 0;
+                ESP_LOGI(TAG, "%s (0x%02X) %s", s_known_devices[i].name,
+                         s_known_devices[i].address, present ? "attached" : "detached");
+                if (s_hotplug_cb) {
+                    s_hotplug_cb(s_known_devices[i].address, present, s_hotplug_ctx);
+                }
+            }
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(I2C_DISCOVERY_PERIOD_MS));
+    }
+}
+
+esp_err_t i2c_discovery_start(i2c_hotplug_cb_t cb, void *user_ctx)
+{
+    if (g_i2c_bus == NULL) {
+        esp_err_t err = i2c_master_init();
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    if (!i2c_init_claim(&s_discovery_state)) {
+        return ESP_OK;
+    }
+
+    s_hotplug_cb = cb;
+    s_hotplug_ctx = user_ctx;
+
+    /* 先用上次缓存的结果，启动不等待探测；后台任务随即校正并产生热插拔事件 */
+    s_present_mask = i2c_discovery_load();
+    ESP_LOGI(TAG, "Cached I2C devices: 0x%02lX", s_present_mask);
+
+    if (xTaskCreate(i2c_discovery_task, "i2c_discovery", 3072, NULL, 3, &s_discovery_task) != pdPASS) {
+        i2c_init_finish(&s_discovery_state, false);
+        return ESP_ERR_NO_MEM;
+    }
+    i2c_init_finish(&s_discovery_state, true);
+    return ESP_OK;
+}
+
+bool i2c_device_present(uint16_t address)
+{
+    for (int i = 0; i < I2C_KNOWN_COUNT; i++) {
+        if (s_known_devices[i].address == address) {
+            return (s_present_mask & (1u << i)) != 0;
+        }
+    }
+    return false;
+}
+
+void i2c_device_set_sleeping(uint16_t address, bool sleeping)
+{
+    for (int i = 0; i < I2C_KNOWN_COUNT; i++) {
+        if (s_known_devices[i].address == address) {
+            if (sleeping) {
+                s_sleeping_mask |= 1u << i;
+            } else {
+                s_sleeping_mask &= ~(1u << i);
+            }
+            return;
+        }
+    }
+}
+
+esp_err_t i2c_bus_hold_sda_low(uint32_t hold_ms)
+{
+    if (g_i2c_bus == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t err = i2c_bus_lock(-1);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    /* SCL 保持空闲高电平，SDA 临时切到 GPIO 输出并拉低 */
+    gpio_set_level(I2C_MASTER_SDA_IO, 0);
+    esp_rom_gpio_connect_out_signal(I2C_MASTER_SDA_IO, SIG_GPIO_OUT_IDX, false, false);
+    /* vTaskDelay(n) 最短可能只等 n-1 个 tick 多一点，多等一个 tick 保证拉低时间不少于 hold_ms */
+    vTaskDelay(pdMS_TO_TICKS(hold_ms) + 1);
+    gpio_set_level(I2C_MASTER_SDA_IO, 1);
+
+    /* 恢复 I2C 外设信号路由并复位控制器状态 */
+    esp_rom_gpio_connect_out_signal(I2C_MASTER_SDA_IO, i2c_periph_signal[I2C_MASTER_NUM].sda_out_sig, false, false);
+    err = i2c_master_bus_reset(g_i2c_bus);
+
+    i2c_bus_unlock();
+    return err;
+}
+
 /**
  * @description:
- * I2C 扫描（新版，语义等价老版）
+ * I2C 扫描（调试用，全地址）
  *
  * 行为说明：
  * - 对 0x01 ~ 0x7E 逐个地址
- * - 发送一次真实 I2C 地址阶段
+ * - i2c_master_probe 只产生 START + SLA + STOP，不注册/注销设备
  * - 依赖 ACK 判断设备是否存在
  */
 void i2c_scan(void)
@@ -72,34 +726,9 @@ void i2c_scan(void)
     ESP_LOGI(TAG, "Start I2C scan...");
 
     for (uint8_t addr = 1; addr < 0x7F; addr++) {
-
-        i2c_master_dev_handle_t dev = NULL;
-
-        i2c_device_config_t dev_cfg = {
-            .dev_addr_length = I2C_ADDR_BIT_7,
-            .device_address = addr,
-            .scl_speed_hz = I2C_MASTER_FREQ_HZ,
-        };
-
-        /* 注册设备（仅软件对象，不产生总线行为） */
-        esp_err_t err = i2c_master_bus_add_device(g_i2c_bus, &dev_cfg, &dev);
-        if (err != ESP_OK) {
-            continue;
-        }
-
-        /*
-         * 关键点：
-         * 0 字节 receive 会触发：
-         * START + SLA+R + STOP
-         * 是否 ACK == 是否存在设备
-         */
-        err = i2c_master_receive(dev, NULL, 0, 10);
-
-        if (err == ESP_OK) {
+        if (i2c_probe_locked(addr) == ESP_OK) {
             ESP_LOGI(TAG, "Found device at 0x%02X", addr);
         }
-
-        i2c_master_bus_rm_device(dev);
     }
 
     ESP_LOGI(TAG, "I2C scan done");
@@ -16,8 +16,12 @@
  */
 #pragma once
 
+#include <stdint.h>
+#include <stdbool.h>
 #include "esp_err.h"
 #include "driver/i2c_types.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 #define I2C_MASTER_SCL_IO GPIO_NUM_4 /*!< GPIO number used for I2C master clock */
 #define I2C_MASTER_SDA_IO GPIO_NUM_5 /*!< GPIO number used for I2C master data  */
@@ -27,7 +31,160 @@
 #define I2C_MASTER_RX_BUF_DISABLE 0  /*!< I2C master doesn't need buffer */
 #define I2C_MASTER_TIMEOUT_MS 1000
 
+#define I2C_BUS_MAX_DEVICES 8        /*!< 总线注册表容量 */
+#define I2C_BUS_ASYNC_QUEUE_LEN 16   /*!< 异步事务队列深度 */
+#define I2C_BUS_ASYNC_TX_MAX 8       /*!< 异步写数据内联拷贝上限 */
+#define I2C_BUS_ASYNC_TIMEOUT_MS 20  /*!< 异步事务默认超时 */
+#define I2C_BUS_DEFAULT_DEADLINE_MS 10  /*!< 单次事务默认截止时间（仅约束总线上的传输） */
+#define I2C_BUS_LOCK_WAIT_MS 50      /*!< 等待其他任务释放总线的上限，与事务截止时间分开计算 */
+#define I2C_BUS_LAT_BUCKETS 8        /*!< 延迟直方图桶数：<100us,<200,<500,<1ms,<2,<5,<10,>=10ms */
+#define I2C_BUS_FAIL_QUARANTINE 6    /*!< 连续失败该次数后暂停访问该设备，须大于驱动层单次读取的重试次数 */
+#define I2C_DISCOVERY_PERIOD_MS 5000 /*!< 后台重新探测周期 */
+
+#define I2C_BUS_ERR_QUARANTINED ESP_ERR_NOT_ALLOWED /*!< 设备处于隔离期，事务未执行 */
+
+/* 总线上的一个设备（由总线注册表统一分配） */
+typedef struct
+{
+    const char *name;                   /*!< 设备名，用于日志与统计 */
+    uint16_t address;                   /*!< 7 位地址 */
+    uint32_t scl_speed_hz;              /*!< 该设备的 SCL 频率 */
+    i2c_master_dev_handle_t handle;     /*!< IDF 设备句柄 */
+
+    int deadline_ms;                    /*!< 单次事务截止时间 */
+
+    uint32_t xfer_count;                /*!< 事务数 */
+    uint32_t error_count;               /*!< 失败事务数（NACK 等） */
+    uint32_t timeout_count;             /*!< 超时事务数 */
+    uint32_t skipped_count;             /*!< 隔离期内被拒绝的事务数 */
+    uint32_t lock_timeout_count;        /*!< 等待总线锁超时的事务数 */
+    uint64_t busy_us;                   /*!< 累计占用总线时间 */
+    uint32_t max_latency_us;            /*!< 最大事务延迟 */
+    uint32_t latency_hist[I2C_BUS_LAT_BUCKETS]; /*!< 事务延迟直方图 */
+
+    uint32_t consecutive_fails;         /*!< 连续失败次数 */
+    int64_t quarantine_until;           /*!< 隔离截止时刻（us） */
+} i2c_bus_device_t;
+
+typedef i2c_bus_device_t *i2c_bus_dev_handle_t;
+
+/* 总线占用统计 */
+typedef struct
+{
+    uint64_t window_us;                 /*!< 统计窗口长度 */
+    uint64_t busy_us;                   /*!< 窗口内总线占用时间 */
+    float utilization;                  /*!< 占用率 0~1 */
+    uint32_t xfer_count;                /*!< 窗口内事务数 */
+    uint32_t recovery_count;            /*!< 累计总线恢复次数 */
+} i2c_bus_stats_t;
+
+/* 异步事务完成回调（在 I2C 工作任务中执行，不可长时间阻塞） */
+typedef void (*i2c_bus_done_cb_t)(i2c_bus_dev_handle_t dev, esp_err_t err, void *user_ctx);
+
+/* 异步事务描述 */
+typedef struct
+{
+    i2c_bus_dev_handle_t dev;
+    uint8_t tx[I2C_BUS_ASYNC_TX_MAX];   /*!< 写数据（提交时拷贝） */
+    size_t tx_len;
+    uint8_t *rx;                        /*!< 读缓冲区，完成前必须保持有效 */
+    size_t rx_len;
+    int timeout_ms;                     /*!< 0 表示使用默认超时 */
+    i2c_bus_done_cb_t cb;               /*!< 完成回调，可为 NULL */
+    void *user_ctx;
+    TaskHandle_t notify_task;           /*!< 完成后通知的任务（ulTaskNotifyTake），可为 NULL */
+} i2c_bus_async_req_t;
+
+/* 热插拔事件回调（在发现任务中执行） */
+typedef void (*i2c_hotplug_cb_t)(uint16_t address, bool present, void *user_ctx);
+
 extern i2c_master_bus_handle_t g_i2c_bus;
 
 extern esp_err_t i2c_master_init(void);
-extern void i2c_scan();
\ No newline at end of file
+extern void i2c_scan();
+
+/**
+ * @description: 在共享总线上注册设备（总线未初始化时自动初始化）
+ */
+esp_err_t i2c_bus_add_device(const char *name, uint16_t address, uint32_t scl_speed_hz, i2c_bus_dev_handle_t *out);
+
+/**
+ * @description: 设置设备单次事务截止时间（调用方超时更长时以此为准）
+ */
+esp_err_t i2c_bus_set_deadline(i2c_bus_dev_handle_t dev, int deadline_ms);
+
+/**
+ * @description: 总线恢复：SCL 翻转释放被拉低的 SDA 并复位控制器
+ */
+esp_err_t i2c_bus_recover(void);
+
+/**
+ * @description: 注销设备
+ */
+esp_err_t i2c_bus_remove_device(i2c_bus_dev_handle_t dev);
+
+/**
+ * @description: 锁定总线，保证多次事务之间不被其他任务插入（可重入）
+ */
+esp_err_t i2c_bus_lock(int timeout_ms);
+void i2c_bus_unlock(void);
+
+/**
+ * @description: 串行化的总线事务
+ */
+esp_err_t i2c_bus_write(i2c_bus_dev_handle_t dev, const uint8_t *data, size_t len, int timeout_ms);
+esp_err_t i2c_bus_read(i2c_bus_dev_handle_t dev, uint8_t *data, size_t len, int timeout_ms);
+esp_err_t i2c_bus_write_read(i2c_bus_dev_handle_t dev, const uint8_t *tx, size_t tx_len,
+                             uint8_t *rx, size_t rx_len, int timeout_ms);
+
+/**
+ * @description: 提交异步事务，立即返回；队列满返回 ESP_ERR_NO_MEM
+ */
+esp_err_t i2c_bus_submit(const i2c_bus_async_req_t *req);
+
+/**
+ * @description: 异步写后读（寄存器读取）
+ */
+esp_err_t i2c_bus_write_read_async(i2c_bus_dev_handle_t dev, const uint8_t *tx, size_t tx_len,
+                                   uint8_t *rx, size_t rx_len, i2c_bus_done_cb_t cb, void *user_ctx);
+
+/**
+ * @description: 异步写
+ */
+esp_err_t i2c_bus_write_async(i2c_bus_dev_handle_t dev, const uint8_t *data, size_t len,
+                              i2c_bus_done_cb_t cb, void *user_ctx);
+
+/**
+ * @description: 当前排队中的异步事务数
+ */
+uint32_t i2c_bus_async_pending(void);
+
+/**
+ * @description: 启动设备发现：立即加载 NVS 缓存结果，后台探测已知地址并上报热插拔
+ */
+esp_err_t i2c_discovery_start(i2c_hotplug_cb_t cb, void *user_ctx);
+
+/**
+ * @description: 已知设备当前是否在线
+ */
+bool i2c_device_present(uint16_t address);
+
+/**
+ * @description: 标记设备进入/退出休眠，休眠期间发现服务保留其在线状态而不探测
+ */
+void i2c_device_set_sleeping(uint16_t address, bool sleeping);
+
+/**
+ * @description: 保持 SCL 空闲、将 SDA 拉低指定时间（SMBus 设备唤醒时序），之后恢复总线
+ */
+esp_err_t i2c_bus_hold_sda_low(uint32_t hold_ms);
+
+/**
+ * @description: 获取总线占用率并开始新的统计窗口
+ */
+void i2c_bus_get_stats(i2c_bus_stats_t *out);
+
+/**
+ * @description: 打印总线及各设备统计
+ */
+void i2c_bus_log_stats(void);
\ No newline at end of file
@@ -0,0 +1,312 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+#include "cuff.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "power.h"
+
+static const char* TAG = "CUFF";
+
+#define CUFF_SAMPLE_STALE_US    200000  // 超过 200ms 无新压力采样视为传感器失效
+#define CUFF_INFLATE_TIMEOUT_US 30000000
+#define CUFF_PUMP_SLOW_MMHG     10.0f   // 距目标小于该值时减速加压
+#define CUFF_HOLD_TOPUP_MMHG    5.0f    // 保压阶段低于目标该值时补气
+#define CUFF_EMPTY_MMHG         3.0f    // 排气完成判定
+#define CUFF_DUMP_MIN_US        3000000 // 阀全开超过该时间且无新采样即视为已排空
+#define CUFF_VALVE_KP           0.08f   // 泄气阀 PI 参数（占空比比例 / mmHg）
+#define CUFF_VALVE_KI           0.02f
+#define CUFF_VALVE_BASE         0.15f   // 泄气阀前馈开度
+
+static cuff_config_t s_cfg;
+static esp_timer_handle_t s_timer = NULL;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static cuff_state_t s_state = CUFF_STATE_IDLE;
+static float s_pressure = 0;
+static int64_t s_pressure_ts = 0;
+static int64_t s_phase_start = 0;
+static float s_integral = 0;
+
+static uint32_t duty_max(const pwm_config_t* pwm)
+{
+    return (1u << pwm->duty_resolution) - 1;
+}
+
+static void set_outputs(float pump, float valve)
+{
+    if (pump < 0) pump = 0;
+    if (pump > 1) pump = 1;
+    if (valve < 0) valve = 0;
+    if (valve > 1) valve = 1;
+
+    pwm_set_duty(s_cfg.pump.channel, (uint32_t)(pump * duty_max(&s_cfg.pump)), s_cfg.pump.speed_mode);
+    pwm_set_duty(s_cfg.valve.channel, (uint32_t)(valve * duty_max(&s_cfg.valve)), s_cfg.valve.speed_mode);
+
+    power_set_level(POWER_SUBSYS_PUMP, pump);
+    power_set_level(POWER_SUBSYS_VALVE, valve);
+}
+
+#define CUFF_STATE_ANY ((cuff_state_t)-1)     // enter_state_from 不比较当前状态
+
+/**
+ * @brief 状态迁移，任务与定时器回调都会调用，在 s_lock 内比较并切换
+ *
+ * @param from 期望的当前状态，CUFF_STATE_ANY 表示不比较
+ * @param state 目标状态
+ * @param now 当前时间
+ * @return bool 是否切换成功（当前状态已被另一方改变时失败）
+ */
+static bool enter_state_from(cuff_state_t from, cuff_state_t state, int64_t now)
+{
+    cuff_state_t old;
+    float p;
+
+    portENTER_CRITICAL(&s_lock);
+    old = s_state;
+    p = s_pressure;
+    const bool ok = (from == CUFF_STATE_ANY || old == from);
+    if (ok)
+    {
+        s_state = state;
+        s_phase_start = now;
+        s_integral = 0;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (ok && old != state)
+    {
+        ESP_LOGI(TAG, "State %d -> %d at %.1f mmHg", old, state, p);
+    }
+    return ok;
+}
+
+/**
+ * @brief 控制回路，运行于 esp_timer 回调
+ */
+static void cuff_control_cb(void* arg)
+{
+    const int64_t now = esp_timer_get_time();
+    float p;
+    int64_t ts;
+    cuff_state_t state;
+    int64_t phase_start;
+
+    // 状态可能同时被任务中的 cuff_start / cuff_stop 修改，先取快照，迁移时再比较
+    portENTER_CRITICAL(&s_lock);
+    p = s_pressure;
+    ts = s_pressure_ts;
+    state = s_state;
+    phase_start = s_phase_start;
+    portEXIT_CRITICAL(&s_lock);
+
+    const float elapsed_s = (float)(now - phase_start) / 1e6f;
+
+    if (state != CUFF_STATE_IDLE && state != CUFF_STATE_DUMP)
+    {
+        if (now - ts > CUFF_SAMPLE_STALE_US)
+        {
+            ESP_LOGE(TAG, "Pressure samples stale, dumping");
+            enter_state_from(state, CUFF_STATE_DUMP, now);
+            state = CUFF_STATE_DUMP;
+        }
+        else if (p > s_cfg.max_mmhg)
+        {
+            ESP_LOGE(TAG, "Over pressure %.1f mmHg, dumping", p);
+            enter_state_from(state, CUFF_STATE_DUMP, now);
+            state = CUFF_STATE_DUMP;
+        }
+    }
+
+    switch (state)
+    {
+    case CUFF_STATE_INFLATE:
+        if (p >= s_cfg.target_mmhg)
+        {
+            if (enter_state_from(state, CUFF_STATE_HOLD, now)) set_outputs(0, 0);
+        }
+        else if (now - phase_start > CUFF_INFLATE_TIMEOUT_US)
+        {
+            ESP_LOGE(TAG, "Inflate timeout (cuff leak?), dumping");
+            enter_state_from(state, CUFF_STATE_DUMP, now);
+            set_outputs(0, 1);
+        }
+        else
+        {
+            float err = s_cfg.target_mmhg - p;
+            set_outputs(err > CUFF_PUMP_SLOW_MMHG ? 1.0f : 0.4f + 0.6f * err / CUFF_PUMP_SLOW_MMHG, 0);
+        }
+        break;
+
+    case CUFF_STATE_HOLD:
+        if (elapsed_s * 1000.0f >= (float)s_cfg.hold_ms)
+        {
+            enter_state_from(state, CUFF_STATE_DEFLATE, now);
+        }
+        else
+        {
+            set_outputs(p < s_cfg.target_mmhg - CUFF_HOLD_TOPUP_MMHG ? 0.4f : 0, 0);
+        }
+        break;
+
+    case CUFF_STATE_DEFLATE:
+        {
+            /* 设定值按时间线性下降，阀门 PI 跟踪 */
+            float setpoint = s_cfg.target_mmhg - s_cfg.deflate_mmhg_s * elapsed_s;
+            if (setpoint <= s_cfg.end_mmhg || p <= s_cfg.end_mmhg)
+            {
+                enter_state_from(state, CUFF_STATE_DUMP, now);
+                set_outputs(0, 1);
+                break;
+            }
+
+            float err = p - setpoint;
+            float dt = 1.0f / (float)s_cfg.control_hz;
+            bool valid;
+            float out = 0;
+            portENTER_CRITICAL(&s_lock);
+            valid = (s_state == CUFF_STATE_DEFLATE);
+            if (valid)
+            {
+                out = CUFF_VALVE_BASE + CUFF_VALVE_KP * err + CUFF_VALVE_KI * (s_integral + err * dt);
+                if (out > 0 && out < 1)
+                {
+                    s_integral += err * dt; // 输出饱和时停止积分，防止积分饱和
+                }
+            }
+            portEXIT_CRITICAL(&s_lock);
+            if (valid)
+            {
+                set_outputs(0, out);
+            }
+            break;
+        }
+
+    case CUFF_STATE_DUMP:
+        set_outputs(0, 1);
+        if (now - ts <= CUFF_SAMPLE_STALE_US)
+        {
+            // 仍有采样：以压力判定排空
+            if (p < CUFF_EMPTY_MMHG)
+            {
+                enter_state_from(state, CUFF_STATE_IDLE, now);
+            }
+        }
+        else if (now - phase_start >= CUFF_DUMP_MIN_US)
+        {
+            // 测量结束后采样任务不再读压力，阀门全开足够久即视为已排空
+            enter_state_from(state, CUFF_STATE_IDLE, now);
+        }
+        break;
+
+    case CUFF_STATE_IDLE:
+    default:
+        break;
+    }
+}
+
+esp_err_t cuff_init(const cuff_config_t* config)
+{
+    if (config == NULL || config->control_hz == 0 || config->target_mmhg > config->max_mmhg)
+    {
+        ESP_LOGE(TAG, "Invalid cuff configuration");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_timer != NULL)
+    {
+        ESP_LOGW(TAG, "Cuff controller already initialized");
+        return ESP_OK;
+    }
+
+    s_cfg = *config;
+
+    esp_err_t err = pwm_init(&s_cfg.pump);
+    if (err != ESP_OK) return err;
+    err = pwm_init(&s_cfg.valve);
+    if (err != ESP_OK) return err;
+
+    // 上电默认泵停阀开
+    set_outputs(0, 1);
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = cuff_control_cb,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "cuff_ctrl",
+        .skip_unhandled_events = true,
+    };
+    err = esp_timer_create(&timer_args, &s_timer);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to create control timer: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Cuff controller initialized: target=%.0f mmHg, rate=%.1f mmHg/s, %lu Hz",
+             s_cfg.target_mmhg, s_cfg.deflate_mmhg_s, s_cfg.control_hz);
+    return ESP_OK;
+}
+
+esp_err_t cuff_start(void)
+{
+    if (s_timer == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_lock);
+    s_pressure_ts = now;
+    portEXIT_CRITICAL(&s_lock);
+    if (!enter_state_from(CUFF_STATE_IDLE, CUFF_STATE_INFLATE, now))
+    {
+        ESP_LOGD(TAG, "Cuff busy (state %d)", cuff_get_state());
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (!esp_timer_is_active(s_timer))
+    {
+        return esp_timer_start_periodic(s_timer, 1000000ULL / s_cfg.control_hz);
+    }
+    return ESP_OK;
+}
+
+void cuff_stop(void)
+{
+    if (s_timer == NULL)
+    {
+        return;
+    }
+    if (cuff_get_state() != CUFF_STATE_IDLE)
+    {
+        enter_state_from(CUFF_STATE_ANY, CUFF_STATE_DUMP, esp_timer_get_time());
+    }
+    set_outputs(0, 1);
+}
+
+void cuff_update_pressure(float mmhg)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_pressure = mmhg;
+    s_pressure_ts = esp_timer_get_time();
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void cuff_set_deflate_rate(float mmhg_s)
+{
+    if (mmhg_s > 0)
+    {
+        s_cfg.deflate_mmhg_s = mmhg_s;
+    }
+}
+
+cuff_state_t cuff_get_state(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    const cuff_state_t state = s_state;
+    portEXIT_CRITICAL(&s_lock);
+    return state;
+}
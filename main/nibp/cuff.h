@@ -0,0 +1,80 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+#ifndef HEALTHY_MCU_CUFF_H
+#define HEALTHY_MCU_CUFF_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "pwm.h"
+
+/*
+ * 袖带气泵 / 泄气阀闭环控制
+ *
+ * 控制回路由 esp_timer 周期回调驱动（高优先级定时器任务），
+ * 不受其他任务负载影响，保证放气速率线性。
+ * 压力由采样任务通过 cuff_update_pressure() 输入。
+ */
+
+typedef enum
+{
+    CUFF_STATE_IDLE = 0,        /*!< 空闲，泵停阀开 */
+    CUFF_STATE_INFLATE,         /*!< 加压至目标压力 */
+    CUFF_STATE_HOLD,            /*!< 保压 */
+    CUFF_STATE_DEFLATE,         /*!< 按设定速率线性放气 */
+    CUFF_STATE_DUMP,            /*!< 快速排气 */
+} cuff_state_t;
+
+typedef struct
+{
+    pwm_config_t pump;          /*!< 气泵 PWM */
+    pwm_config_t valve;         /*!< 泄气阀 PWM（占空比越大开度越大） */
+    float target_mmhg;          /*!< 加压目标 */
+    uint32_t hold_ms;           /*!< 保压时间 */
+    float deflate_mmhg_s;       /*!< 线性放气速率 mmHg/s */
+    float end_mmhg;             /*!< 放气至该压力后快速排气 */
+    float max_mmhg;             /*!< 过压保护阈值 */
+    uint32_t control_hz;        /*!< 控制频率 */
+} cuff_config_t;
+
+/**
+ * @brief 初始化气泵与泄气阀 PWM，并创建控制定时器
+ *
+ * @param config 控制参数
+ * @return esp_err_t ESP-IDF错误码
+ */
+esp_err_t cuff_init(const cuff_config_t* config);
+
+/**
+ * @brief 开始一次 加压-保压-放气 过程
+ *
+ * @return esp_err_t ESP-IDF错误码
+ */
+esp_err_t cuff_start(void);
+
+/**
+ * @brief 立即停止并快速排气
+ */
+void cuff_stop(void);
+
+/**
+ * @brief 输入最新袖带压力（采样任务调用）
+ *
+ * @param mmhg 袖带压力
+ */
+void cuff_update_pressure(float mmhg);
+
+/**
+ * @brief 设置放气速率
+ *
+ * @param mmhg_s 放气速率 mmHg/s
+ */
+void cuff_set_deflate_rate(float mmhg_s);
+
+/**
+ * @brief 获取当前控制状态
+ */
+cuff_state_t cuff_get_state(void);
+
+#endif //HEALTHY_MCU_CUFF_H
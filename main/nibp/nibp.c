@@ -0,0 +1,375 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+#include "nibp.h"
+
+#include <math.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char* TAG = "NIBP";
+
+#define NIBP_HP_CUTOFF_HZ       0.5f    // 高通截止频率
+#define NIBP_LP_CUTOFF_HZ       5.0f    // 低通截止频率（不超过 0.4 倍采样率）
+#define NIBP_HYST_MMHG          0.05f   // 过零检测迟滞
+#define NIBP_MIN_AMP_MMHG       0.1f    // 小于该幅值视为噪声
+#define NIBP_MIN_BEAT_S         0.33f   // 最短搏动间隔（180 bpm）
+#define NIBP_MAX_BEAT_S         2.0f    // 最长搏动间隔（30 bpm）
+#define NIBP_DEFLATE_DROP_MMHG  3.0f    // 压力自峰值回落该值后判定开始放气
+
+/* -------------------------------------------------------------------------- */
+/*                                  滤波器                                     */
+/* -------------------------------------------------------------------------- */
+
+static void biquad_design(nibp_biquad_t* f, float fc, float fs, bool highpass)
+{
+    const float w0 = 2.0f * (float)M_PI * fc / fs;
+    const float c = cosf(w0);
+    const float alpha = sinf(w0) / (2.0f * 0.70710678f);
+    const float a0 = 1.0f + alpha;
+
+    if (highpass)
+    {
+        f->b0 = (1.0f + c) / 2.0f / a0;
+        f->b1 = -(1.0f + c) / a0;
+    }
+    else
+    {
+        f->b0 = (1.0f - c) / 2.0f / a0;
+        f->b1 = (1.0f - c) / a0;
+    }
+    f->b2 = f->b0;
+    f->a1 = -2.0f * c / a0;
+    f->a2 = (1.0f - alpha) / a0;
+    f->z1 = 0;
+    f->z2 = 0;
+}
+
+static inline float biquad_run(nibp_biquad_t* f, float x)
+{
+    float y = f->b0 * x + f->z1;
+    f->z1 = f->b1 * x - f->a1 * y + f->z2;
+    f->z2 = f->b2 * x - f->a2 * y;
+    return y;
+}
+
+/* 以稳态值预置滤波器状态，避免阶跃引起的长时间振铃 */
+static void biquad_prime(nibp_biquad_t* f, float x)
+{
+    float dc_gain = (f->b0 + f->b1 + f->b2) / (1.0f + f->a1 + f->a2);
+    float y = x * dc_gain;
+    f->z1 = y - f->b0 * x;
+    f->z2 = f->b2 * x - f->a2 * y;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  包络                                       */
+/* -------------------------------------------------------------------------- */
+
+static void envelope_push(nibp_t* nibp, float pressure, float amp, uint32_t width)
+{
+    if (nibp->env_n == NIBP_MAX_BEATS)
+    {
+        /* 满后两两合并，内存恒定，分辨率减半 */
+        for (int i = 0; i < NIBP_MAX_BEATS / 2; i++)
+        {
+            const float c0 = nibp->env_c[2 * i];
+            const float c1 = nibp->env_c[2 * i + 1];
+            nibp->env_p[i] = (nibp->env_p[2 * i] * c0 + nibp->env_p[2 * i + 1] * c1) / (c0 + c1);
+            nibp->env_a[i] = (nibp->env_a[2 * i] * c0 + nibp->env_a[2 * i + 1] * c1) / (c0 + c1);
+            nibp->env_w[i] = nibp->env_w[2 * i] + nibp->env_w[2 * i + 1];
+            nibp->env_c[i] = nibp->env_c[2 * i] + nibp->env_c[2 * i + 1];
+        }
+        nibp->env_n = NIBP_MAX_BEATS / 2;
+        nibp->env_merge *= 2;
+        ESP_LOGD(TAG, "Envelope full, merged to %d points", nibp->env_n);
+    }
+
+    /* 合并后新搏动先并入末点，凑满 env_merge 个才开新点，各点分辨率保持一致 */
+    const int last = nibp->env_n - 1;
+    if (last >= 0 && nibp->env_c[last] < nibp->env_merge)
+    {
+        const float c = nibp->env_c[last];
+        nibp->env_p[last] = (nibp->env_p[last] * c + pressure) / (c + 1.0f);
+        nibp->env_a[last] = (nibp->env_a[last] * c + amp) / (c + 1.0f);
+        nibp->env_w[last] += width;
+        nibp->env_c[last]++;
+        return;
+    }
+
+    nibp->env_p[nibp->env_n] = pressure;
+    nibp->env_a[nibp->env_n] = amp;
+    nibp->env_w[nibp->env_n] = width;
+    nibp->env_c[nibp->env_n] = 1;
+    nibp->env_n++;
+}
+
+static float interp_pressure(const nibp_t* nibp, const float* amp, int i, int j, float thr)
+{
+    float da = amp[j] - amp[i];
+    if (fabsf(da) < 1e-6f)
+    {
+        return nibp->env_p[i];
+    }
+    return nibp->env_p[i] + (thr - amp[i]) * (nibp->env_p[j] - nibp->env_p[i]) / da;
+}
+
+static esp_err_t envelope_evaluate(nibp_t* nibp)
+{
+    const int n = nibp->env_n;
+    float amp[NIBP_MAX_BEATS];
+
+    if (n < 5)
+    {
+        ESP_LOGW(TAG, "Too few beats: %d", n);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    /* 三点滑动平均平滑包络 */
+    amp[0] = nibp->env_a[0];
+    amp[n - 1] = nibp->env_a[n - 1];
+    for (int i = 1; i < n - 1; i++)
+    {
+        amp[i] = (nibp->env_a[i - 1] + nibp->env_a[i] + nibp->env_a[i + 1]) / 3.0f;
+    }
+
+    int imax = 0;
+    for (int i = 1; i < n; i++)
+    {
+        if (amp[i] > amp[imax])
+        {
+            imax = i;
+        }
+    }
+
+    /* 包络最大值必须被两侧点包围，否则加压不足或放气过早结束 */
+    if (imax == 0 || imax == n - 1)
+    {
+        ESP_LOGW(TAG, "Envelope peak not bracketed (idx=%d, n=%d)", imax, n);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const float amax = amp[imax];
+    const float sys_thr = amax * NIBP_SYS_RATIO;
+    const float dia_thr = amax * NIBP_DIA_RATIO;
+    float sys = NAN, dia = NAN;
+
+    /* 放气过程中索引越小压力越高：收缩压在最大值之前 */
+    for (int i = imax; i > 0; i--)
+    {
+        if (amp[i - 1] < sys_thr)
+        {
+            sys = interp_pressure(nibp, amp, i - 1, i, sys_thr);
+            break;
+        }
+    }
+
+    for (int i = imax; i < n - 1; i++)
+    {
+        if (amp[i + 1] < dia_thr)
+        {
+            dia = interp_pressure(nibp, amp, i, i + 1, dia_thr);
+            break;
+        }
+    }
+
+    if (isnan(sys) || isnan(dia))
+    {
+        ESP_LOGW(TAG, "Ratio threshold not crossed (sys=%.1f, dia=%.1f)", sys, dia);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    uint32_t width = 0;
+    int beats = 0;
+    for (int i = 0; i < n; i++)
+    {
+        width += nibp->env_w[i];
+        beats += nibp->env_c[i];
+    }
+
+    nibp->result.map = nibp->env_p[imax];
+    nibp->result.sys = sys;
+    nibp->result.dia = dia;
+    nibp->result.beats = beats;
+    nibp->result.heart_rate = width > 0
+                                  ? 60.0f * nibp->cfg.sample_rate_hz * (float)nibp->result.beats / (float)width
+                                  : 0;
+    return ESP_OK;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  逐搏检测                                    */
+/* -------------------------------------------------------------------------- */
+
+static void beat_detect(nibp_t* nibp, float osc)
+{
+    const float fs = nibp->cfg.sample_rate_hz;
+
+    if (nibp->beat_open)
+    {
+        if (osc > nibp->beat_max) nibp->beat_max = osc;
+        if (osc < nibp->beat_min) nibp->beat_min = osc;
+        nibp->beat_p_sum += nibp->pressure;
+        nibp->beat_n++;
+    }
+
+    if (osc < -NIBP_HYST_MMHG)
+    {
+        nibp->below = true;
+        return;
+    }
+
+    if (!nibp->below || osc < NIBP_HYST_MMHG)
+    {
+        return;
+    }
+
+    /* 上穿：结束上一个搏动，开始新搏动 */
+    nibp->below = false;
+
+    if (nibp->beat_open)
+    {
+        uint32_t width = nibp->samples - nibp->beat_start;
+        float amp = nibp->beat_max - nibp->beat_min;
+
+        if (width >= (uint32_t)(NIBP_MIN_BEAT_S * fs) &&
+            width <= (uint32_t)(NIBP_MAX_BEAT_S * fs) &&
+            amp >= NIBP_MIN_AMP_MMHG)
+        {
+            envelope_push(nibp, nibp->beat_p_sum / (float)nibp->beat_n, amp, width);
+        }
+        else if (width < (uint32_t)(NIBP_MIN_BEAT_S * fs))
+        {
+            /* 间隔过短视为同一搏动内的毛刺，继续累计 */
+            return;
+        }
+    }
+
+    nibp->beat_open = true;
+    nibp->beat_start = nibp->samples;
+    nibp->beat_max = osc;
+    nibp->beat_min = osc;
+    nibp->beat_p_sum = nibp->pressure;
+    nibp->beat_n = 1;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  公共接口                                    */
+/* -------------------------------------------------------------------------- */
+
+esp_err_t nibp_init(nibp_t* nibp, const nibp_config_t* config)
+{
+    if (nibp == NULL || config == NULL || config->counts_per_mmhg == 0 || config->sample_rate_hz <= 0)
+    {
+        ESP_LOGE(TAG, "Invalid NIBP configuration");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(nibp, 0, sizeof(*nibp));
+    nibp->cfg = *config;
+
+    float lp_fc = NIBP_LP_CUTOFF_HZ;
+    if (lp_fc > config->sample_rate_hz * 0.4f)
+    {
+        lp_fc = config->sample_rate_hz * 0.4f;
+    }
+    biquad_design(&nibp->hp, NIBP_HP_CUTOFF_HZ, config->sample_rate_hz, true);
+    biquad_design(&nibp->lp, lp_fc, config->sample_rate_hz, false);
+
+    nibp->env_merge = 1;
+    nibp->error = ESP_ERR_INVALID_STATE;
+    nibp->state = NIBP_STATE_INFLATING;
+
+    ESP_LOGI(TAG, "NIBP started: fs=%.1f Hz, band=%.1f~%.1f Hz",
+             config->sample_rate_hz, NIBP_HP_CUTOFF_HZ, lp_fc);
+    return ESP_OK;
+}
+
+nibp_state_t nibp_feed(nibp_t* nibp, int32_t raw)
+{
+    if (nibp->state != NIBP_STATE_INFLATING && nibp->state != NIBP_STATE_DEFLATING)
+    {
+        return nibp->state;
+    }
+
+    nibp->samples++;
+    nibp->pressure = (float)(raw - nibp->cfg.zero_offset) / nibp->cfg.counts_per_mmhg;
+
+    if (nibp->samples > (uint32_t)(nibp->cfg.max_duration_s * nibp->cfg.sample_rate_hz))
+    {
+        ESP_LOGW(TAG, "Measurement timeout");
+        nibp->error = ESP_ERR_TIMEOUT;
+        nibp->state = NIBP_STATE_ERROR;
+        return nibp->state;
+    }
+
+    if (nibp->state == NIBP_STATE_INFLATING)
+    {
+        if (nibp->pressure > nibp->peak_pressure)
+        {
+            nibp->peak_pressure = nibp->pressure;
+        }
+        if (nibp->peak_pressure < nibp->cfg.start_peak_mmhg ||
+            nibp->pressure > nibp->peak_pressure - NIBP_DEFLATE_DROP_MMHG)
+        {
+            return nibp->state;
+        }
+        ESP_LOGI(TAG, "Deflation detected, peak=%.1f mmHg", nibp->peak_pressure);
+        nibp->state = NIBP_STATE_DEFLATING;
+    }
+
+    if (!nibp->filter_primed)
+    {
+        biquad_prime(&nibp->hp, nibp->pressure);
+        biquad_prime(&nibp->lp, 0);
+        nibp->filter_primed = true;
+    }
+
+    float osc = biquad_run(&nibp->lp, biquad_run(&nibp->hp, nibp->pressure));
+    beat_detect(nibp, osc);
+
+    if (nibp->pressure < nibp->cfg.end_mmhg)
+    {
+        return nibp_finish(nibp);
+    }
+    return nibp->state;
+}
+
+nibp_state_t nibp_finish(nibp_t* nibp)
+{
+    if (nibp->state != NIBP_STATE_INFLATING && nibp->state != NIBP_STATE_DEFLATING)
+    {
+        return nibp->state;
+    }
+
+    nibp->error = envelope_evaluate(nibp);
+    nibp->state = nibp->error == ESP_OK ? NIBP_STATE_DONE : NIBP_STATE_ERROR;
+
+    if (nibp->state == NIBP_STATE_DONE)
+    {
+        ESP_LOGI(TAG, "SYS=%.0f DIA=%.0f MAP=%.0f HR=%.0f (%d beats)",
+                 nibp->result.sys, nibp->result.dia, nibp->result.map,
+                 nibp->result.heart_rate, nibp->result.beats);
+    }
+    return nibp->state;
+}
+
+esp_err_t nibp_get_result(const nibp_t* nibp, nibp_result_t* out)
+{
+    if (nibp == NULL || out == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (nibp->state != NIBP_STATE_DONE)
+    {
+        return nibp->error;
+    }
+    *out = nibp->result;
+    return ESP_OK;
+}
+
+float nibp_pressure(const nibp_t* nibp)
+{
+    return nibp->pressure;
+}
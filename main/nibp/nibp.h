@@ -0,0 +1,142 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+#ifndef HEALTHY_MCU_NIBP_H
+#define HEALTHY_MCU_NIBP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/*
+ * 示波法无创血压（NIBP）测量引擎
+ *
+ * 以 HX710B 原生速率逐点输入袖带压力，流式完成：
+ * 压力换算 -> 带通滤波提取振荡波 -> 逐搏幅值检测 -> 包络（有界存储）
+ * 放气结束后按幅值比例法计算平均压 / 收缩压 / 舒张压。
+ */
+
+#define NIBP_MAX_BEATS          96      // 包络最多保存的搏动点数，满后两两合并
+#define NIBP_SYS_RATIO          0.55f   // 收缩压幅值比例
+#define NIBP_DIA_RATIO          0.85f   // 舒张压幅值比例
+
+typedef struct
+{
+    int32_t zero_offset;        /*!< 袖带排空时的原始零点 */
+    float counts_per_mmhg;      /*!< 标定系数（原始值 / mmHg），需按实际传感器标定 */
+    float sample_rate_hz;       /*!< 采样率 */
+    float start_peak_mmhg;      /*!< 峰值压力超过该值后才开始判定放气 */
+    float end_mmhg;             /*!< 放气至该压力以下结束测量 */
+    float max_duration_s;       /*!< 单次测量最长时间 */
+} nibp_config_t;
+
+#define NIBP_DEFAULT_CONFIG() {             \
+    .zero_offset = 0,                       \
+    .counts_per_mmhg = 4200.0f,             \
+    .sample_rate_hz = 40.0f,                \
+    .start_peak_mmhg = 60.0f,               \
+    .end_mmhg = 40.0f,                      \
+    .max_duration_s = 120.0f,               \
+}
+
+typedef enum
+{
+    NIBP_STATE_IDLE = 0,        /*!< 未开始 */
+    NIBP_STATE_INFLATING,       /*!< 加压中，等待压力峰值 */
+    NIBP_STATE_DEFLATING,       /*!< 放气中，采集振荡包络 */
+    NIBP_STATE_DONE,            /*!< 测量完成，可读取结果 */
+    NIBP_STATE_ERROR,           /*!< 测量失败 */
+} nibp_state_t;
+
+typedef struct
+{
+    float map;                  /*!< 平均压 mmHg */
+    float sys;                  /*!< 收缩压 mmHg */
+    float dia;                  /*!< 舒张压 mmHg */
+    float heart_rate;           /*!< 心率 bpm */
+    int beats;                  /*!< 参与计算的搏动数 */
+} nibp_result_t;
+
+/* 二阶 IIR 节（直接 II 型转置） */
+typedef struct
+{
+    float b0, b1, b2, a1, a2;
+    float z1, z2;
+} nibp_biquad_t;
+
+typedef struct
+{
+    nibp_config_t cfg;
+    nibp_state_t state;
+
+    nibp_biquad_t hp;           /*!< 0.5Hz 高通，去除放气趋势 */
+    nibp_biquad_t lp;           /*!< 低通，抑制高频噪声 */
+    bool filter_primed;
+
+    uint32_t samples;           /*!< 已输入采样数 */
+    float pressure;             /*!< 当前袖带压力 mmHg */
+    float peak_pressure;        /*!< 加压阶段最高压力 */
+
+    /* 逐搏检测 */
+    bool below;                 /*!< 振荡波已低于负迟滞门限 */
+    bool beat_open;             /*!< 已找到第一个上穿点 */
+    float beat_max;
+    float beat_min;
+    float beat_p_sum;
+    uint32_t beat_n;
+    uint32_t beat_start;
+
+    /* 包络 */
+    float env_p[NIBP_MAX_BEATS];
+    float env_a[NIBP_MAX_BEATS];
+    uint32_t env_w[NIBP_MAX_BEATS];  /*!< 每点合并的搏动间隔（采样数） */
+    uint16_t env_c[NIBP_MAX_BEATS];  /*!< 每点实际包含的搏动数 */
+    int env_n;
+    int env_merge;              /*!< 每个包络点当前代表的搏动数 */
+
+    nibp_result_t result;
+    esp_err_t error;
+} nibp_t;
+
+/**
+ * @brief 初始化测量引擎，进入加压等待状态
+ *
+ * @param nibp 引擎实例
+ * @param config 配置
+ * @return esp_err_t ESP-IDF错误码
+ */
+esp_err_t nibp_init(nibp_t* nibp, const nibp_config_t* config);
+
+/**
+ * @brief 输入一个原始采样
+ *
+ * @param nibp 引擎实例
+ * @param raw HX710B 原始值
+ * @return nibp_state_t 输入后的状态
+ */
+nibp_state_t nibp_feed(nibp_t* nibp, int32_t raw);
+
+/**
+ * @brief 主动结束采集并计算结果（例如放气阀已全开）
+ *
+ * @param nibp 引擎实例
+ * @return nibp_state_t 结束后的状态
+ */
+nibp_state_t nibp_finish(nibp_t* nibp);
+
+/**
+ * @brief 获取测量结果
+ *
+ * @param nibp 引擎实例
+ * @param out 结果
+ * @return esp_err_t ESP_ERR_INVALID_STATE 表示未完成，其余为测量失败原因
+ */
+esp_err_t nibp_get_result(const nibp_t* nibp, nibp_result_t* out);
+
+/**
+ * @brief 当前袖带压力（mmHg）
+ */
+float nibp_pressure(const nibp_t* nibp);
+
+#endif //HEALTHY_MCU_NIBP_H
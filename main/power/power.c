@@ -0,0 +1,219 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+#include "power.h"
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+static const char* TAG = "POWER";
+
+#define POWER_BASE_MA       25.0f   // MCU + 传感器待机的基础电流
+#define POWER_BATT_IIR      8       // 电池电压平滑系数 1/8（负载突变时的压降不计入电量）
+#define POWER_LEVEL_FULL    1000    // 占空比以千分比累计
+
+/* 各子系统满功率时的标称电流（mA） */
+static const float s_nominal_ma[POWER_SUBSYS_COUNT] = {
+    [POWER_SUBSYS_STATUS_LED] = 10.0f,
+    [POWER_SUBSYS_MAX30102_LED] = 0.8f,     // 2 x 10mA，411us 脉宽 @100sps 的平均值
+    [POWER_SUBSYS_PUMP] = 250.0f,
+    [POWER_SUBSYS_VALVE] = 120.0f,
+    [POWER_SUBSYS_BLE] = 40.0f,
+};
+
+static const char* const s_names[POWER_SUBSYS_COUNT] = {
+    "status_led", "max30102_led", "pump", "valve", "ble",
+};
+
+/* 单节锂电池开路电压 -> 剩余电量 */
+typedef struct
+{
+    uint16_t mv;
+    uint8_t soc;
+} soc_point_t;
+
+static const soc_point_t s_soc_curve[] = {
+    {4200, 100}, {4100, 90}, {4000, 80}, {3920, 70}, {3870, 60}, {3820, 50},
+    {3790, 40}, {3770, 30}, {3740, 20}, {3680, 10}, {3450, 5}, {3000, 0},
+};
+
+typedef struct
+{
+    uint16_t level;         // 当前占空比（千分比）
+    int64_t since_us;       // 当前占空比开始的时间
+    uint64_t weighted_us;   // sum(时长 * 占空比)
+} subsys_state_t;
+
+static power_config_t s_cfg;
+static bool s_inited = false;
+static subsys_state_t s_subsys[POWER_SUBSYS_COUNT];
+static int64_t s_window_start = 0;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static float s_batt_mv = 0;
+
+/* -------------------------------------------------------------------------- */
+/*                                 电池电压                                     */
+/* -------------------------------------------------------------------------- */
+
+static void power_battery_cb(int raw, int voltage_mv)
+{
+    const float mv = (float)voltage_mv * s_cfg.divider_ratio;
+    if (s_batt_mv == 0)
+    {
+        s_batt_mv = mv;
+    }
+    else
+    {
+        s_batt_mv += (mv - s_batt_mv) / POWER_BATT_IIR;
+    }
+}
+
+static float soc_from_mv(float mv)
+{
+    const int n = sizeof(s_soc_curve) / sizeof(s_soc_curve[0]);
+    if (mv >= s_soc_curve[0].mv) return s_soc_curve[0].soc;
+    if (mv <= s_soc_curve[n - 1].mv) return s_soc_curve[n - 1].soc;
+
+    for (int i = 1; i < n; i++)
+    {
+        if (mv >= s_soc_curve[i].mv)
+        {
+            const soc_point_t* hi = &s_soc_curve[i - 1];
+            const soc_point_t* lo = &s_soc_curve[i];
+            return lo->soc + (hi->soc - lo->soc) * (mv - lo->mv) / (float)(hi->mv - lo->mv);
+        }
+    }
+    return 0;
+}
+
+uint32_t power_battery_mv(void)
+{
+    return (uint32_t)s_batt_mv;
+}
+
+float power_battery_soc(void)
+{
+    return soc_from_mv(s_batt_mv);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 能耗统计                                     */
+/* -------------------------------------------------------------------------- */
+
+esp_err_t power_init(const power_config_t* config)
+{
+    if (config == NULL || config->divider_ratio <= 0 || config->publish_period_ms == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_inited)
+    {
+        return ESP_OK;
+    }
+
+    s_cfg = *config;
+
+    const int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < POWER_SUBSYS_COUNT; i++)
+    {
+        s_subsys[i].since_us = now;
+    }
+    s_window_start = now;
+    portEXIT_CRITICAL(&s_lock);
+
+    esp_err_t err = adc_tool_start(s_cfg.unit, s_cfg.channel, s_cfg.atten, power_battery_cb);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Battery ADC start failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    s_inited = true;
+    ESP_LOGI(TAG, "Power telemetry started: divider %.2f, %lu mAh, every %lu ms",
+             s_cfg.divider_ratio, s_cfg.capacity_mah, s_cfg.publish_period_ms);
+    return ESP_OK;
+}
+
+void power_set_level(power_subsys_t subsys, float level)
+{
+    if (subsys >= POWER_SUBSYS_COUNT)
+    {
+        return;
+    }
+    if (level < 0) level = 0;
+    if (level > 1) level = 1;
+
+    const uint16_t permille = (uint16_t)(level * POWER_LEVEL_FULL + 0.5f);
+    subsys_state_t* s = &s_subsys[subsys];
+    if (s->level == permille)
+    {
+        return;
+    }
+
+    /* 控制回路高频调用，只在占空比变化时结算 */
+    const int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_lock);
+    s->weighted_us += (uint64_t)(now - s->since_us) * s->level;
+    s->since_us = now;
+    s->level = permille;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void power_set_active(power_subsys_t subsys, bool active)
+{
+    power_set_level(subsys, active ? 1.0f : 0.0f);
+}
+
+void power_publish(power_report_t* out)
+{
+    power_report_t report = {0};
+    uint64_t weighted[POWER_SUBSYS_COUNT];
+
+    const int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < POWER_SUBSYS_COUNT; i++)
+    {
+        subsys_state_t* s = &s_subsys[i];
+        weighted[i] = s->weighted_us + (uint64_t)(now - s->since_us) * s->level;
+        s->weighted_us = 0;
+        s->since_us = now;
+    }
+    report.window_s = (float)(now - s_window_start) / 1e6f;
+    s_window_start = now;
+    portEXIT_CRITICAL(&s_lock);
+
+    float total_mah = POWER_BASE_MA * report.window_s / 3600.0f;
+    for (int i = 0; i < POWER_SUBSYS_COUNT; i++)
+    {
+        report.subsys[i].active_s = (float)weighted[i] / POWER_LEVEL_FULL / 1e6f;
+        report.subsys[i].charge_mah = s_nominal_ma[i] * report.subsys[i].active_s / 3600.0f;
+        total_mah += report.subsys[i].charge_mah;
+    }
+
+    report.battery_mv = power_battery_mv();
+    report.soc = power_battery_soc();
+    report.avg_ma = report.window_s > 0 ? total_mah * 3600.0f / report.window_s : POWER_BASE_MA;
+    report.runtime_h = report.avg_ma > 0 ? s_cfg.capacity_mah * report.soc / 100.0f / report.avg_ma : 0;
+
+    ESP_LOGI(TAG, "Battery %lu mV (%.0f%%), avg %.1f mA over %.0f s, ~%.1f h left",
+             report.battery_mv, report.soc, report.avg_ma, report.window_s, report.runtime_h);
+    for (int i = 0; i < POWER_SUBSYS_COUNT; i++)
+    {
+        if (report.subsys[i].active_s > 0)
+        {
+            ESP_LOGI(TAG, "  %-12s %7.1f s  %7.3f mAh", s_names[i],
+                     report.subsys[i].active_s, report.subsys[i].charge_mah);
+        }
+    }
+
+    if (out)
+    {
+        *out = report;
+    }
+}
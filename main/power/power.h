@@ -0,0 +1,86 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+#ifndef HEALTHY_MCU_POWER_H
+#define HEALTHY_MCU_POWER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "adc.h"
+#include "esp_err.h"
+
+/**
+ * @brief 参与能耗统计的子系统
+ */
+typedef enum
+{
+    POWER_SUBSYS_STATUS_LED = 0,    // 状态灯 / 蜂鸣器（GPIO12）
+    POWER_SUBSYS_MAX30102_LED,      // MAX30102 红光 + 红外 LED
+    POWER_SUBSYS_PUMP,              // 袖带气泵
+    POWER_SUBSYS_VALVE,             // 袖带泄气阀
+    POWER_SUBSYS_BLE,               // BLE 射频（扫描 / 连接）
+    POWER_SUBSYS_COUNT,
+} power_subsys_t;
+
+typedef struct
+{
+    adc_unit_t unit;
+    adc_channel_t channel;
+    adc_atten_t atten;
+    float divider_ratio;            // 电池电压 / ADC 引脚电压
+    uint32_t capacity_mah;          // 电池容量
+    uint32_t publish_period_ms;     // 统计发布周期
+} power_config_t;
+
+#define POWER_DEFAULT_CONFIG() {            \
+    .unit = ADC_UNIT_1,                     \
+    .channel = ADC_CHANNEL_3,               \
+    .atten = ADC_ATTEN_DB_12,               \
+    .divider_ratio = 2.0f,                  \
+    .capacity_mah = 5000,                   \
+    .publish_period_ms = 60000,             \
+}
+
+typedef struct
+{
+    float active_s;                 // 折算为满功率的工作时间
+    float charge_mah;               // 消耗电荷
+} power_subsys_usage_t;
+
+typedef struct
+{
+    uint32_t battery_mv;
+    float soc;                      // 剩余电量 0~100 %
+    float window_s;                 // 本统计窗口时长
+    float avg_ma;                   // 窗口内平均电流（含基础电流）
+    float runtime_h;                // 按平均电流估算的剩余续航
+    power_subsys_usage_t subsys[POWER_SUBSYS_COUNT];
+} power_report_t;
+
+/**
+ * @brief 初始化电池采样（基于 adc_tool）与能耗统计
+ */
+esp_err_t power_init(const power_config_t* config);
+
+/**
+ * @brief 子系统开关状态变化时调用
+ */
+void power_set_active(power_subsys_t subsys, bool active);
+
+/**
+ * @brief PWM 类负载按占空比 0~1 计入
+ */
+void power_set_level(power_subsys_t subsys, float level);
+
+/**
+ * @brief 结算当前统计窗口，生成报告并开始新窗口
+ */
+void power_publish(power_report_t* out);
+
+uint32_t power_battery_mv(void);
+
+float power_battery_soc(void);
+
+#endif //HEALTHY_MCU_POWER_H
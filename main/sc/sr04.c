@@ -5,13 +5,18 @@
 
 #include "sr04.h"
 
+#include <math.h>
 #include <stdio.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 #include "esp_timer.h"
+#include "esp_log.h"
 #include "driver/gpio.h"
 #include "rom/ets_sys.h"
 
+static const char* TAG = "SR04";
+
 // -------------------------
 // 引脚定义
 // -------------------------
@@ -23,50 +28,344 @@
 // -------------------------
 #define TIMEOUT_US 50000  // 50ms
 
+#define SR04_RESULT_QUEUE_LEN 4
+
+#define SR04_HEIGHT_MIN_VALID 3     // 身高测量最少有效回波数
+#define SR04_HEIGHT_TOL_CM 2.0f     // 离散度达到该值时置信度降为 0
+#define SR04_OUTLIER_MAD 3.0f       // 偏离中位数超过 3 倍 MAD 视为离群值
+
 // -------------------------
-// 测距函数
+// 异步测距状态
 // -------------------------
-float get_distance_cm(void)
+static QueueHandle_t s_result_queue = NULL;
+static esp_timer_handle_t s_timeout_timer = NULL;
+static esp_timer_handle_t s_periodic_timer = NULL;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static volatile bool s_busy = false;        // 测距进行中
+static volatile uint32_t s_seq = 0;         // 当前测距序号
+static uint32_t s_timer_seq = 0;            // 超时定时器对应的测距序号（s_lock 保护）
+static int64_t s_trig_time = 0;             // 触发时刻
+static int64_t s_echo_start = 0;            // 回波上升沿时刻
+static uint32_t s_dropped = 0;              // 队列满丢弃的结果数（s_lock 保护）
+
+static void IRAM_ATTR post_result_isr(esp_err_t err, int64_t start, int64_t end, BaseType_t* woken)
+{
+    sr04_result_t res = {
+        .err = err,
+        .echo_us = (uint32_t)(end - start),
+        .timestamp_us = end,
+    };
+    // HC-SR04 公式: 距离(cm) = 时间(us) / 58
+    res.distance_cm = err == ESP_OK ? (float)res.echo_us / 58.0f : -1.0f;
+
+    // 调用者已退出临界区，队列操作不能在自旋锁内进行
+    if (xQueueSendFromISR(s_result_queue, &res, woken) != pdTRUE)
+    {
+        portENTER_CRITICAL_ISR(&s_lock);
+        s_dropped++;
+        portEXIT_CRITICAL_ISR(&s_lock);
+    }
+}
+
+// -------------------------
+// ECHO 双边沿中断：记录时间戳
+// -------------------------
+static void IRAM_ATTR echo_isr_handler(void* arg)
+{
+    int64_t now = esp_timer_get_time();
+    int64_t start = 0;
+    bool done = false;
+    BaseType_t woken = pdFALSE;
+
+    portENTER_CRITICAL_ISR(&s_lock);
+    if (s_busy)
+    {
+        if (gpio_get_level(ECHO_GPIO))
+        {
+            s_echo_start = now;
+        }
+        else if (s_echo_start != 0)
+        {
+            s_busy = false;
+            start = s_echo_start;
+            done = true;
+        }
+    }
+    portEXIT_CRITICAL_ISR(&s_lock);
+
+    if (done)
+    {
+        post_result_isr(ESP_OK, start, now, &woken);
+    }
+
+    if (woken)
+    {
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+// -------------------------
+// 超时回调（esp_timer 任务上下文）
+// -------------------------
+static void timeout_cb(void* arg)
+{
+    bool timed_out = false;
+    sr04_result_t res = {0};
+
+    portENTER_CRITICAL(&s_lock);
+    if (s_busy && s_seq == s_timer_seq)
+    {
+        s_busy = false;
+        timed_out = true;
+        res.timestamp_us = esp_timer_get_time();
+        res.echo_us = (uint32_t)(res.timestamp_us - s_trig_time);
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (timed_out)
+    {
+        res.err = ESP_ERR_TIMEOUT;
+        res.distance_cm = -1.0f;
+        if (xQueueSend(s_result_queue, &res, 0) != pdTRUE)
+        {
+            portENTER_CRITICAL(&s_lock);
+            s_dropped++;
+            portEXIT_CRITICAL(&s_lock);
+        }
+    }
+}
+
+static void periodic_cb(void* arg)
+{
+    sr04_ping_start();
+}
+
+esp_err_t sr04_ping_start(void)
 {
-    int64_t echo_start = 0;
-    int64_t echo_end = 0;
+    if (s_result_queue == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    int64_t now = esp_timer_get_time();
+    uint32_t seq;
+
+    portENTER_CRITICAL(&s_lock);
+    if (s_busy || (s_trig_time != 0 && now - s_trig_time < SR04_MIN_PING_INTERVAL_MS * 1000))
+    {
+        portEXIT_CRITICAL(&s_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_busy = true;
+    s_seq++;
+    seq = s_seq;
+    s_echo_start = 0;
+    s_trig_time = now;
+    portEXIT_CRITICAL(&s_lock);
 
     // 发 10us TRIG 脉冲
-    gpio_set_level(TRIG_GPIO, 0);
-    ets_delay_us(2);
     gpio_set_level(TRIG_GPIO, 1);
     ets_delay_us(10);
     gpio_set_level(TRIG_GPIO, 0);
 
-    // 等待 Echo 引脚变高，同时加超时保护
-    int64_t start_wait = esp_timer_get_time();
-    while (gpio_get_level(ECHO_GPIO) == 0)
+    // 超时保护：回波未开始或过长
+    esp_timer_stop(s_timeout_timer);
+    portENTER_CRITICAL(&s_lock);
+    s_timer_seq = seq;
+    portEXIT_CRITICAL(&s_lock);
+    return esp_timer_start_once(s_timeout_timer, TIMEOUT_US);
+}
+
+esp_err_t sr04_wait_result(sr04_result_t* out, TickType_t timeout)
+{
+    if (s_result_queue == NULL || out == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (xQueueReceive(s_result_queue, out, timeout) != pdTRUE)
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+esp_err_t sr04_start_continuous(uint32_t period_ms)
+{
+    if (s_result_queue == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (period_ms < SR04_MIN_PING_INTERVAL_MS)
+    {
+        period_ms = SR04_MIN_PING_INTERVAL_MS;
+    }
+
+    if (s_periodic_timer == NULL)
     {
-        if (esp_timer_get_time() - start_wait > TIMEOUT_US)
+        const esp_timer_create_args_t args = {
+            .callback = periodic_cb,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "sr04_ping",
+        };
+        esp_err_t err = esp_timer_create(&args, &s_periodic_timer);
+        if (err != ESP_OK)
         {
-            printf("超时未检测到回波！\n");
-            return -1.0f;
+            return err;
         }
     }
-    echo_start = esp_timer_get_time();
+    esp_timer_stop(s_periodic_timer);
+    xQueueReset(s_result_queue);
+    ESP_LOGI(TAG, "Continuous ranging every %lu ms", period_ms);
+    return esp_timer_start_periodic(s_periodic_timer, (uint64_t)period_ms * 1000);
+}
+
+void sr04_stop_continuous(void)
+{
+    if (s_periodic_timer)
+    {
+        esp_timer_stop(s_periodic_timer);
+    }
+}
+
+// -------------------------
+// 测距函数（阻塞等待，期间任务挂起）
+// -------------------------
+float get_distance_cm(void)
+{
+    sr04_result_t res;
+
+    xQueueReset(s_result_queue);
+    esp_err_t err = sr04_ping_start();
+    if (err == ESP_ERR_INVALID_STATE)
+    {
+        // 距上次触发不足最小间隔，稍后重试
+        vTaskDelay(pdMS_TO_TICKS(SR04_MIN_PING_INTERVAL_MS));
+        err = sr04_ping_start();
+    }
+    if (err != ESP_OK)
+    {
+        return -1.0f;
+    }
 
-    // 等待 Echo 引脚变低，同时加超时保护
-    start_wait = esp_timer_get_time();
-    while (gpio_get_level(ECHO_GPIO) == 1)
+    if (sr04_wait_result(&res, pdMS_TO_TICKS(TIMEOUT_US / 1000 + 20)) != ESP_OK || res.err != ESP_OK)
     {
-        if (esp_timer_get_time() - start_wait > TIMEOUT_US)
+        printf("超时未检测到回波！\n");
+        return -1.0f;
+    }
+    return res.distance_cm;
+}
+
+// -------------------------
+// 身高测量
+// -------------------------
+float sr04_speed_of_sound(float temp_c)
+{
+    return 331.3f + 0.606f * temp_c;
+}
+
+static void sort_u32(uint32_t* v, int n)
+{
+    for (int i = 1; i < n; i++)
+    {
+        uint32_t x = v[i];
+        int j = i - 1;
+        while (j >= 0 && v[j] > x)
         {
-            printf("回波信号过长或丢失！\n");
-            return -1.0f;
+            v[j + 1] = v[j];
+            j--;
         }
+        v[j + 1] = x;
     }
-    echo_end = esp_timer_get_time();
+}
 
-    int64_t pulse_width_us = echo_end - echo_start;
+esp_err_t sr04_measure_height(float temp_c, sr04_height_t* out)
+{
+    uint32_t echo[SR04_HEIGHT_PINGS];
+    uint32_t dev[SR04_HEIGHT_PINGS];
+    int n = 0;
 
-    // HC-SR04 公式: 距离(cm) = 时间(us) / 58
-    float distance = (float)pulse_width_us / 58.0f;
-    return distance;
+    if (s_result_queue == NULL || out == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    sr04_stop_continuous();
+    xQueueReset(s_result_queue);
+
+    // 节拍粒度与唤醒抖动会让间隔略小于最小间隔，多留一个节拍
+    const TickType_t period = pdMS_TO_TICKS(SR04_MIN_PING_INTERVAL_MS) + 1;
+    TickType_t last = xTaskGetTickCount();
+    for (int i = 0; i < SR04_HEIGHT_PINGS; i++)
+    {
+        if (i > 0)
+        {
+            xTaskDelayUntil(&last, period);
+        }
+
+        // 仍被间隔保护拒绝时逐节拍重试，不丢弃该次采样
+        esp_err_t err = sr04_ping_start();
+        for (int retry = 0; err == ESP_ERR_INVALID_STATE && retry < 3; retry++)
+        {
+            vTaskDelay(1);
+            err = sr04_ping_start();
+        }
+        if (err != ESP_OK)
+        {
+            ESP_LOGW(TAG, "Height: ping %d not started: %s", i, esp_err_to_name(err));
+            continue;
+        }
+
+        sr04_result_t res;
+        if (sr04_wait_result(&res, pdMS_TO_TICKS(TIMEOUT_US / 1000 + 20)) == ESP_OK && res.err == ESP_OK)
+        {
+            echo[n++] = res.echo_us;
+        }
+    }
+
+    if (n < SR04_HEIGHT_MIN_VALID)
+    {
+        ESP_LOGW(TAG, "Height: only %d/%d valid echoes", n, SR04_HEIGHT_PINGS);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // 中位数与中位数绝对偏差（MAD）
+    sort_u32(echo, n);
+    uint32_t median = echo[n / 2];
+    for (int i = 0; i < n; i++)
+    {
+        dev[i] = echo[i] > median ? echo[i] - median : median - echo[i];
+    }
+    sort_u32(dev, n);
+    // MAD 下限约 1cm 回波时间，避免全部相同时误剔除
+    float limit = SR04_OUTLIER_MAD * fmaxf((float)dev[n / 2], 58.0f);
+
+    float sum = 0, sum_sq = 0;
+    int inliers = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (fabsf((float)echo[i] - (float)median) <= limit)
+        {
+            sum += (float)echo[i];
+            sum_sq += (float)echo[i] * (float)echo[i];
+            inliers++;
+        }
+    }
+
+    // 距离(cm) = 时间(us) * 声速(m/s) / 2 / 10^4
+    const float cm_per_us = sr04_speed_of_sound(temp_c) / 20000.0f;
+    float mean = sum / (float)inliers;
+    float std_cm = sqrtf(fmaxf(sum_sq / (float)inliers - mean * mean, 0)) * cm_per_us;
+
+    out->temp_c = temp_c;
+    out->valid_pings = inliers;
+    out->distance_cm = mean * cm_per_us;
+    out->height_cm = SR04_MOUNT_HEIGHT_CM - out->distance_cm;
+    out->confidence = (float)inliers / (float)SR04_HEIGHT_PINGS * fmaxf(0, 1.0f - std_cm / SR04_HEIGHT_TOL_CM);
+
+    ESP_LOGD(TAG, "Height %.1f cm (dist %.1f, std %.2f, %d/%d, %.1f C)",
+             out->height_cm, out->distance_cm, std_cm, inliers, SR04_HEIGHT_PINGS, temp_c);
+    return ESP_OK;
 }
 
 // -------------------------
@@ -79,7 +378,34 @@ void sr04_gpio_set(void)
     gpio_set_direction(TRIG_GPIO, GPIO_MODE_OUTPUT);
     gpio_set_level(TRIG_GPIO, 0);
 
-    // ECHO 输入
-    gpio_reset_pin(ECHO_GPIO);
-    gpio_set_direction(ECHO_GPIO, GPIO_MODE_INPUT);
-}
\ No newline at end of file
+    // ECHO 输入，双边沿中断
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << ECHO_GPIO,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_ANYEDGE,
+    };
+    gpio_config(&io_conf);
+
+    if (s_result_queue == NULL)
+    {
+        s_result_queue = xQueueCreate(SR04_RESULT_QUEUE_LEN, sizeof(sr04_result_t));
+
+        const esp_timer_create_args_t args = {
+            .callback = timeout_cb,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "sr04_tmo",
+        };
+        esp_timer_create(&args, &s_timeout_timer);
+    }
+
+    // ISR 服务可能已被其他驱动安装
+    esp_err_t err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE)
+    {
+        ESP_LOGE(TAG, "Failed to install GPIO ISR service: %s", esp_err_to_name(err));
+        return;
+    }
+    gpio_isr_handler_add(ECHO_GPIO, echo_isr_handler, NULL);
+}
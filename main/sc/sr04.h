@@ -5,7 +5,86 @@
 #ifndef STELLARIS_C_SR04_H
 #define STELLARIS_C_SR04_H
 
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#define SR04_MIN_PING_INTERVAL_MS 60 // 传感器两次触发的最小间隔（余波衰减）
+
+// 单次测距结果
+typedef struct
+{
+    esp_err_t err;          // ESP_OK / ESP_ERR_TIMEOUT
+    uint32_t echo_us;       // 回波高电平宽度
+    float distance_cm;      // 按 20℃ 声速换算的距离
+    int64_t timestamp_us;   // 回波结束时刻
+} sr04_result_t;
+
+// 身高测量结果
+typedef struct
+{
+    float height_cm;        // 身高 = 安装高度 - 距离
+    float distance_cm;      // 剔除离群值后的平均距离
+    float confidence;       // 置信度 0~1
+    int valid_pings;        // 参与计算的回波数
+    float temp_c;           // 声速补偿所用温度
+} sr04_height_t;
+
+#define SR04_MOUNT_HEIGHT_CM 220.0f // 探头到地面的安装高度
+#define SR04_HEIGHT_PINGS 7         // 每次身高测量的触发次数（7 x 60ms < 0.5s）
+
 void sr04_start(void* pvParameters);
 void sr04_gpio_set(void);
+
+/**
+ * @brief 发出一次触发脉冲，回波由 GPIO 中断计时，结果进入队列
+ *
+ * @return esp_err_t ESP_ERR_INVALID_STATE 表示上一次测距未完成或间隔不足
+ */
+esp_err_t sr04_ping_start(void);
+
+/**
+ * @brief 等待一次测距结果（阻塞期间不占用 CPU）
+ *
+ * @param out 结果
+ * @param timeout 等待时间
+ * @return esp_err_t ESP_ERR_TIMEOUT 表示队列中没有结果
+ */
+esp_err_t sr04_wait_result(sr04_result_t* out, TickType_t timeout);
+
+/**
+ * @brief 以固定周期连续测距，结果进入队列
+ *
+ * @param period_ms 周期，小于 SR04_MIN_PING_INTERVAL_MS 时取最小间隔
+ */
+esp_err_t sr04_start_continuous(uint32_t period_ms);
+
+/**
+ * @brief 停止连续测距
+ */
+void sr04_stop_continuous(void);
+
+/**
+ * @brief 指定温度下的声速
+ *
+ * @param temp_c 空气温度 ℃
+ * @return float 声速 m/s
+ */
+float sr04_speed_of_sound(float temp_c);
+
+/**
+ * @brief 身高测量：以最大安全速率连续触发，中位数剔除离群值并按温度修正声速
+ *
+ * @param temp_c 环境温度 ℃（如 MLX90614 的 a_temp）
+ * @param out 测量结果
+ * @return esp_err_t ESP_ERR_NOT_FOUND 表示有效回波不足
+ */
+esp_err_t sr04_measure_height(float temp_c, sr04_height_t* out);
+
+/**
+ * @brief 阻塞测距（发起一次测距并等待结果）
+ *
+ * @return float 距离 cm，失败返回 -1
+ */
 float get_distance_cm(void);
 #endif //STELLARIS_C_SR04_H
@@ -36,6 +36,7 @@
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "esp_timer.h"
+#include "power.h"
 
 // 日志标签定义
 #define GATTC_TAG                   "GATTC_SPP_DEMO"
@@ -375,6 +376,7 @@ static void esp_gap_cb(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* par
             break;
         }
         ESP_LOGI(GATTC_TAG, "Scanning start successfully"); // 扫描启动成功
+        power_set_active(POWER_SUBSYS_BLE, true);
         break;
     case ESP_GAP_BLE_SCAN_STOP_COMPLETE_EVT:
         // 扫描停止完成事件
@@ -384,6 +386,7 @@ static void esp_gap_cb(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* par
             break;
         }
         ESP_LOGI(GATTC_TAG, "Scanning stop successfully"); // 扫描停止成功
+        power_set_active(POWER_SUBSYS_BLE, is_connect); // 仍连接时射频保持工作
         break;
     case ESP_GAP_BLE_SCAN_RESULT_EVT:
         {
@@ -535,6 +538,7 @@ static void gattc_profile_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_
         spp_gattc_if = gattc_if;
         is_connect = true;
         spp_conn_id = p_data->connect.conn_id;
+        power_set_active(POWER_SUBSYS_BLE, true);
         // 搜索SPP服务
         esp_ble_gattc_search_service(spp_gattc_if, spp_conn_id, &spp_service_uuid);
         break;
@@ -8,13 +8,22 @@
 #include "710b.h"
 #include "711.h"
 #include "blood.h"
+#include "bodytemp.h"
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_system.h"
 #include "gpio.h"
+#include "hongwai.h"
+#include "cuff.h"
 #include "max30102.h"
 #include "myi2c.h"
+#include "nibp.h"
+#include "power.h"
+#include "rpc.h"
 #include "sr04.h"
+#include "link.h"
 #include "uart.h"
+#include "uart_tx.h"
 #include "vars.h"
 #include "freertos/FreeRTOS.h"
 
@@ -23,8 +32,15 @@ void max30102_task(void* p)
     float temp, spo2, heart;
 
     ESP_ERROR_CHECK(i2c_master_init());
+    ESP_ERROR_CHECK(i2c_discovery_start(NULL, NULL));
 
-    max30102_handle_t max30102 = max30102_create(g_i2c_bus, MAX30102_Device_address, GPIO_NUM_6);
+    // 传感器未接入时不阻塞其他任务，等待热插拔
+    while (!i2c_device_present(MAX30102_Device_address))
+    {
+        vTaskDelay(pdMS_TO_TICKS(I2C_DISCOVERY_PERIOD_MS));
+    }
+
+    max30102_handle_t max30102 = max30102_create(MAX30102_Device_address, GPIO_NUM_6);
     max30102_config(max30102);
 
     while (1)
@@ -41,23 +57,121 @@ void max30102_task(void* p)
     }
 }
 
+static nibp_t s_nibp;
+
 void hx710b_task(void* p)
 {
     hx710b_t hx710b = {
         .sck_pin = GPIO_NUM_8,
-        .dout_pin = GPIO_NUM_9
+        .dout_pin = GPIO_NUM_9,
+        .rate = HX710B_RATE_40HZ
     };
 
     hx710b_init(&hx710b);
 
+    cuff_config_t cuff_cfg = {
+        .pump = {
+            .timer_num = LEDC_TIMER_1,
+            .speed_mode = LEDC_LOW_SPEED_MODE,
+            .frequency = 20000,
+            .duty_resolution = LEDC_TIMER_10_BIT,
+            .channel = LEDC_CHANNEL_0,
+            .gpio_num = GPIO_NUM_10,
+            .duty = 0,
+        },
+        .valve = {
+            .timer_num = LEDC_TIMER_1,
+            .speed_mode = LEDC_LOW_SPEED_MODE,
+            .frequency = 20000,
+            .duty_resolution = LEDC_TIMER_10_BIT,
+            .channel = LEDC_CHANNEL_1,
+            .gpio_num = GPIO_NUM_13,
+            .duty = 0,
+        },
+        .target_mmhg = 180.0f,
+        .hold_ms = 1000,
+        .deflate_mmhg_s = 3.0f,
+        .end_mmhg = 40.0f,
+        .max_mmhg = 250.0f,
+        .control_hz = 50,
+    };
+    ESP_ERROR_CHECK(cuff_init(&cuff_cfg));
+
+    bool measuring = false;
     while (1)
     {
-        if (data.xveya_status == 1)
+        if (data.xveya_status != 1)
         {
-            int32_t raw = hx710b_read(&hx710b);
-            ESP_LOGI("HX710B", "RAW: %ld", raw);
+            if (measuring)
+            {
+                cuff_stop();
+            }
+            measuring = false;
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+
+        if (!measuring)
+        {
+            // 上一次测量的排气可能尚未结束，等控制器回到空闲（袖带已排空）再取零点
+            for (int i = 0; i < 100 && cuff_get_state() != CUFF_STATE_IDLE; i++)
+            {
+                vTaskDelay(pdMS_TO_TICKS(100));
+            }
+
+            // 袖带排空状态下取零点
+            int64_t sum = 0;
+            for (int i = 0; i < 8; i++)
+            {
+                sum += hx710b_read(&hx710b);
+            }
+
+            nibp_config_t cfg = NIBP_DEFAULT_CONFIG();
+            cfg.zero_offset = (int32_t)(sum / 8);
+            cfg.sample_rate_hz = hx710b_sample_rate(&hx710b);
+            nibp_init(&s_nibp, &cfg);
+            cuff_update_pressure(0);
+            esp_err_t err = cuff_start();
+            if (err != ESP_OK)
+            {
+                ESP_LOGE("HX710B", "Cuff start failed: %s", esp_err_to_name(err));
+                data.xveya_status = 0;
+                continue;
+            }
+            measuring = true;
+        }
+
+        // hx710b_read 等待 DOUT 就绪，循环即以传感器原生速率运行
+        int32_t raw = hx710b_read(&hx710b);
+        nibp_state_t state = nibp_feed(&s_nibp, raw);
+        cuff_update_pressure(nibp_pressure(&s_nibp));
+
+        // 控制器已进入排气（放气结束或保护动作），收尾计算
+        cuff_state_t cuff_state = cuff_get_state();
+        if (state == NIBP_STATE_DEFLATING &&
+            (cuff_state == CUFF_STATE_DUMP || cuff_state == CUFF_STATE_IDLE))
+        {
+            state = nibp_finish(&s_nibp);
+        }
+
+        if (state == NIBP_STATE_DONE || state == NIBP_STATE_ERROR)
+        {
+            nibp_result_t result;
+            esp_err_t err = nibp_get_result(&s_nibp, &result);
+            if (err == ESP_OK)
+            {
+                ESP_LOGI("HX710B", "SYS:%.0f DIA:%.0f MAP:%.0f HR:%.0f",
+                         result.sys, result.dia, result.map, result.heart_rate);
+                data.xveya_var = result.sys;
+            }
+            else
+            {
+                ESP_LOGW("HX710B", "NIBP failed: %s", esp_err_to_name(err));
+            }
+            cuff_stop();
+            data.xveya_status = 0;
+            measuring = false;
         }
-        vTaskDelay(pdMS_TO_TICKS(1000));
     }
 }
 
@@ -71,9 +185,14 @@ void sr04_task(void* p)
     {
         if (data.shengao_status == 1)
         {
-            float distance = get_distance_cm();
-            if (distance > 0)
-                printf("距离: %.2f cm\n", distance);
+            // MLX90614 环境温度无效时按 20℃ 计算声速
+            float temp = (a_temp > -20.0f && a_temp < 60.0f && a_temp != 0) ? a_temp : 20.0f;
+            sr04_height_t height;
+            if (sr04_measure_height(temp, &height) == ESP_OK)
+            {
+                printf("身高: %.1f cm (置信度 %.2f)\n", height.height_cm, height.confidence);
+                data.shengao_var = height.height_cm;
+            }
             else
                 printf("测距失败或超出范围\n");
         }
@@ -81,6 +200,87 @@ void sr04_task(void* p)
     }
 }
 
+#define TEMP_SAMPLE_PERIOD_MS 100     // MLX90614 默认滤波设置下的输出刷新周期
+#define TEMP_SESSION_TIMEOUT_MS 10000
+#define TEMP_WAKE_RETRY 3              // 唤醒时序失败（如总线被占用）时的重试次数
+#define TEMP_WAKE_RETRY_MS 100
+
+void temperature_task(void* p)
+{
+    bodytemp_t bt;
+
+    MLX90614_Init();
+    // 两次测量之间传感器保持睡眠
+    MLX90614_Sleep();
+
+    while (1)
+    {
+        if (data.tiwen_status != 1)
+        {
+            vTaskDelay(pdMS_TO_TICKS(200));
+            continue;
+        }
+
+        esp_err_t wake_err = ESP_FAIL;
+        for (int attempt = 0; attempt < TEMP_WAKE_RETRY; attempt++)
+        {
+            wake_err = MLX90614_Wake();
+            if (wake_err == ESP_OK)
+            {
+                break;
+            }
+            vTaskDelay(pdMS_TO_TICKS(TEMP_WAKE_RETRY_MS));
+        }
+        if (wake_err != ESP_OK)
+        {
+            // 传感器仍在睡眠，IsReady 永远不会成立，直接结束本次测量
+            ESP_LOGE("MLX90614", "唤醒失败: %s，本次测量结束", esp_err_to_name(wake_err));
+            data.tiwen_status = 0;
+            continue;
+        }
+
+        while (!MLX90614_IsReady() && data.tiwen_status == 1)
+        {
+            vTaskDelay(pdMS_TO_TICKS(20));
+        }
+
+        bodytemp_reset(&bt);
+        TickType_t start = xTaskGetTickCount();
+        TickType_t last = start;
+
+        while (data.tiwen_status == 1)
+        {
+            float obj, amb;
+            if (MLX90614_ReadTemp(MLX90614_RAM_TOBJ1, &obj) == ESP_OK &&
+                MLX90614_ReadTemp(MLX90614_RAM_TA, &amb) == ESP_OK)
+            {
+                o_temp = obj;
+                a_temp = amb;
+                bodytemp_update(&bt, obj, amb);
+            }
+
+            bool converged = bodytemp_converged(&bt);
+            bool timeout = xTaskGetTickCount() - start >= pdMS_TO_TICKS(TEMP_SESSION_TIMEOUT_MS);
+            if (converged || timeout)
+            {
+                if (bt.initialized)
+                {
+                    data.tiwen_var = bodytemp_estimate(&bt);
+                }
+                ESP_LOGI("MLX90614", "体温: %.2f (%s, %lu 样本, %lu ms)", data.tiwen_var,
+                         converged ? "收敛" : "超时", bt.samples,
+                         (xTaskGetTickCount() - start) * portTICK_PERIOD_MS);
+                data.tiwen_status = 0;
+                break;
+            }
+
+            vTaskDelayUntil(&last, pdMS_TO_TICKS(TEMP_SAMPLE_PERIOD_MS));
+        }
+
+        MLX90614_Sleep();
+    }
+}
+
 void hx711_task(void* p)
 {
     HX711_init(GPIO_NUM_15, GPIO_NUM_16, eGAIN_128);
@@ -126,56 +326,103 @@ void status_task(void* p)
         {
             gpio_set_level_safe(GPIO_NUM_12, 1);
         }
+        // GPIO12 的最终电平由最后一次写入决定
+        power_set_active(POWER_SUBSYS_STATUS_LED, data.fengmingqi_status != 0);
         vTaskDelay(pdMS_TO_TICKS(500));
     }
 }
 
+void power_task(void* p)
+{
+    power_config_t config = POWER_DEFAULT_CONFIG();
+    ESP_ERROR_CHECK(power_init(&config));
+
+    TickType_t last = xTaskGetTickCount();
+    while (1)
+    {
+        vTaskDelayUntil(&last, pdMS_TO_TICKS(config.publish_period_ms));
+
+        power_report_t report;
+        power_publish(&report);
+        data.dianchi_var = report.soc;
+        data.dianya_var = (int)report.battery_mv;
+    }
+}
+
+/**
+ * @brief RPC 读数方法：返回 ctx 指向的全局测量值
+ */
+static esp_err_t rpc_read_float(const rpc_value_t* arg, rpc_value_t* result, void* ctx)
+{
+    result->type = VAL_TYPE_FLOAT;
+    result->v.f = *(const volatile float*)ctx;
+    return ESP_OK;
+}
+
+static void rpc_register_methods(void)
+{
+    rpc_register("wendu", rpc_read_float, (void*)&data.tiwen_var, 0);
+    rpc_register("xveya", rpc_read_float, (void*)&data.xveya_var, 0);
+    rpc_register("xinlv", rpc_read_float, (void*)&data.xinlv_var, 0);
+    rpc_register("xveyang", rpc_read_float, (void*)&data.xveyang_var, 0);
+    rpc_register("tizhong", rpc_read_float, (void*)&data.tizhong_var, 0);
+    rpc_register("shengao", rpc_read_float, (void*)&data.shengao_var, 0);
+    rpc_register("dianchi", rpc_read_float, (void*)&data.dianchi_var, 0);
+}
 
 void uart_receive_callback(const uint8_t* data, size_t length)
 {
+    // 值内联或借用当前帧，出错与正常路径都无需释放
     iot_data_t recv_node;
-    if (iot_data_decode_cbor(data, 512, &recv_node) == CborNoError)
-    {
-        printf("解码成功:\n ID: %s\n Key: %s\n Type: %d\n Value: %.1f\n Channel: %d\n",
-               recv_node.device_id,
-               recv_node.key,
-               recv_node.type,
-               *(float*)recv_node.value,
-               recv_node.channel);
-        // 重要：释放解码时动态分配的内存
-        free(recv_node.value);
-    }
-    if (recv_node.key == "wendu")
+    if (iot_data_decode_cbor(data, length, &recv_node) != CborNoError)
     {
+        return;
     }
 
-    if (recv_node.key == "xveya")
+    // 波特率协商等链路控制消息不进入业务处理；带 rid 的请求交给 RPC 工作任务，
+    // 接收回调拷贝参数后立即返回，不会被慢方法阻塞
+    if (!link_handle_message(&recv_node) && !rpc_submit(&recv_node))
     {
+        ESP_LOGW("UART", "Ignored message without rid: key=%s channel=%d", recv_node.key, recv_node.channel);
     }
-
-    float current_temp = 28.5f;
-    iot_data_t send_node = {
-        .device_id = "DEV-ESP32-001",
-        .key = "temp",
-        .type = VAL_TYPE_FLOAT,
-        .value = &current_temp, // 指向局部或全局变量
-        .channel = CANNEL_PROPERTY,
-        .timestamp = 1705324800
-    };
-
-    uint8_t buffer[256];
-    size_t cbor_len = iot_data_encode_cbor(&send_node, buffer, sizeof(buffer));
-    printf("编码成功，大小: %zu 字节\n", cbor_len);
-
-    uart_send_data(UART_NUM_1, buffer, cbor_len);
 }
 
 void uart_task(void* p)
 {
-    uart_init(UART_NUM_1, GPIO_NUM_0, GPIO_NUM_1, 9600, uart_receive_callback);
+    uart_init(UART_NUM_1, GPIO_NUM_0, GPIO_NUM_1, LINK_BASE_BAUD, uart_receive_callback);
+    // CBOR 中可能出现任意字节，按帧接收而不是按换行切分
+    uart_set_framing(UART_NUM_1, true);
+    uart_tx_start(UART_NUM_1, true);
+
+    // 从 9600 起步协商更高波特率，失败则保持 9600
+    link_init(UART_NUM_1, "DEV-ESP32-001");
+    link_negotiate();
+
+    rpc_register_methods();
+    rpc_init(UART_NUM_1, "DEV-ESP32-001");
 
+    uint32_t ticks = 0;
     while (1)
     {
+        link_service();
         vTaskDelay(pdMS_TO_TICKS(100));
+
+        // 每 10 s 输出一次运行统计
+        if (++ticks % 100 == 0)
+        {
+            // 共用 I/O 任务的负载，仅供现场观察
+            uart_io_stats_t io;
+            uart_io_get_stats(&io);
+            ESP_LOGI("UART", "I/O: %u ch, %lu wakeups, %lu rx, %lu tx, avg %lu us, max %lu us",
+                     io.channels, io.wakeups, io.rx_events, io.tx_flushes,
+                     io.wakeups ? (uint32_t)(io.busy_us / io.wakeups) : 0, io.max_dispatch_us);
+
+            // 解码统计与堆水位，仅供现场观察；堆不变不能证明无分配（其他任务同样使用堆）
+            iot_decode_stats_t dec;
+            iot_data_get_decode_stats(&dec);
+            ESP_LOGI("UART", "decode: %lu ok, %lu err, %lu inline, %lu borrowed; heap free %lu, min %lu",
+                     dec.decoded, dec.errors, dec.inline_values, dec.borrowed_values,
+                     esp_get_free_heap_size(), esp_get_minimum_free_heap_size());
+        }
     }
 }
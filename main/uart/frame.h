@@ -0,0 +1,70 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+#ifndef HEALTHY_MCU_FRAME_H
+#define HEALTHY_MCU_FRAME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * 串口帧格式：COBS( len16_le | payload | crc16_le ) 0x00
+ * COBS 保证帧内不出现 0x00，因此 0x00 可作为唯一的帧定界符，CBOR 中任意字节都不会误切帧。
+ * CRC-16/CCITT-FALSE（多项式 0x1021，初值 0xFFFF）覆盖长度字段与负载。
+ */
+
+#define UART_FRAME_MAX_PAYLOAD  512
+#define UART_FRAME_OVERHEAD     4   // 长度 + CRC
+#define UART_FRAME_DELIMITER    0x00
+
+// 编码后最大长度：COBS 每 254 字节多 1 字节，再加首个码字节与定界符
+#define UART_FRAME_ENCODED_MAX(n) ((n) + UART_FRAME_OVERHEAD + ((n) + UART_FRAME_OVERHEAD) / 254 + 2)
+
+// 接收到完整且校验通过的帧时调用，payload 仅在回调期间有效
+typedef void (*uart_frame_cb_t)(const uint8_t* payload, size_t length, void* ctx);
+
+typedef struct
+{
+    uint32_t frames;        // 成功交付的帧
+    uint32_t crc_errors;    // CRC 校验失败
+    uint32_t len_errors;    // 长度字段与实际不符
+    uint32_t cobs_errors;   // COBS 码字非法（帧被截断）
+    uint32_t overflows;     // 超过最大帧长
+} uart_frame_stats_t;
+
+/**
+ * @brief 流式解码器，跨 uart_read_bytes 的分片重组帧
+ */
+typedef struct
+{
+    uint8_t buf[UART_FRAME_MAX_PAYLOAD + UART_FRAME_OVERHEAD];
+    size_t len;
+    uint8_t code;           // 当前 COBS 块的码字
+    uint8_t left;           // 当前块剩余数据字节
+    bool started;           // 已读到首个码字
+    bool discard;           // 本帧已出错，丢弃到下一个定界符
+    uart_frame_stats_t stats;
+} uart_frame_decoder_t;
+
+/**
+ * @brief CRC-16/CCITT-FALSE
+ */
+uint16_t uart_frame_crc16(uint16_t crc, const uint8_t* data, size_t len);
+
+/**
+ * @brief 编码一帧（含结尾定界符）
+ *
+ * @return 写入 out 的字节数，缓冲不足或负载过长时返回 0
+ */
+size_t uart_frame_encode(const uint8_t* payload, size_t length, uint8_t* out, size_t out_size);
+
+void uart_frame_decoder_reset(uart_frame_decoder_t* dec);
+
+/**
+ * @brief 向解码器输入任意长度的字节流，每解出一帧调用一次 cb
+ */
+void uart_frame_feed(uart_frame_decoder_t* dec, const uint8_t* data, size_t n, uart_frame_cb_t cb, void* ctx);
+
+#endif //HEALTHY_MCU_FRAME_H
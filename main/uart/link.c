@@ -0,0 +1,415 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+#include "link.h"
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "nvs.h"
+#include "uart.h"
+#include "uart_tx.h"
+
+static const char* TAG = "LINK";
+
+#define LINK_NVS_NS             "link"
+#define LINK_NVS_KEY            "baud"
+#define LINK_REPLY_TIMEOUT_MS   1000    // 等待主机应答报价
+#define LINK_SWITCH_DELAY_MS    20      // 切换后给主机留出重新配置串口的时间
+#define LINK_PROBE_TRIES        3
+#define LINK_PROBE_TIMEOUT_MS   200
+#define LINK_HEALTH_WINDOW_MS   5000    // 错误率统计窗口
+#define LINK_HEALTH_MAX_ERRORS  5       // 窗口内坏帧超过该值即降速
+
+typedef enum
+{
+    LINK_EVT_BAUD = 0,
+    LINK_EVT_PONG,
+} link_evt_type_t;
+
+typedef struct
+{
+    link_evt_type_t type;
+    int value;
+} link_evt_t;
+
+/* 由高到低尝试的波特率 */
+static const uint32_t s_rates[] = {921600, 460800, 230400, 115200, 57600, 38400, 19200, LINK_BASE_BAUD};
+
+static uart_port_t s_uart = UART_NUM_1;
+static char s_device_id[18];
+static QueueHandle_t s_evt = NULL;
+static uint32_t s_baud = LINK_BASE_BAUD;
+static uint32_t s_ceiling = LINK_MAX_BAUD;      // 出错降速后的报价上限
+static uint32_t s_saved = 0;
+
+static int64_t s_window_start = 0;
+static uint32_t s_window_errors = 0;
+static int64_t s_keepalive_at = 0;
+static int64_t s_retry_at = 0;          // 降速失败后重新报价的时刻，0 表示无
+
+static bool rate_supported(uint32_t baud)
+{
+    for (size_t i = 0; i < sizeof(s_rates) / sizeof(s_rates[0]); i++)
+    {
+        if (s_rates[i] == baud) return true;
+    }
+    return false;
+}
+
+static uint32_t rate_below(uint32_t baud)
+{
+    for (size_t i = 0; i < sizeof(s_rates) / sizeof(s_rates[0]); i++)
+    {
+        if (s_rates[i] < baud) return s_rates[i];
+    }
+    return LINK_BASE_BAUD;
+}
+
+static void link_save(uint32_t baud)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(LINK_NVS_NS, NVS_READWRITE, &nvs) != ESP_OK)
+    {
+        return;
+    }
+    nvs_set_u32(nvs, LINK_NVS_KEY, baud);
+    nvs_commit(nvs);
+    nvs_close(nvs);
+    s_saved = baud;
+}
+
+static uint32_t link_load(void)
+{
+    nvs_handle_t nvs;
+    uint32_t baud = 0;
+    if (nvs_open(LINK_NVS_NS, NVS_READONLY, &nvs) == ESP_OK)
+    {
+        nvs_get_u32(nvs, LINK_NVS_KEY, &baud);
+        nvs_close(nvs);
+    }
+    return rate_supported(baud) ? baud : 0;
+}
+
+static uint32_t link_error_count(void)
+{
+    uart_frame_stats_t stats;
+    if (uart_get_frame_stats(s_uart, &stats) != ESP_OK)
+    {
+        return 0;
+    }
+    return stats.crc_errors + stats.len_errors + stats.cobs_errors + stats.overflows;
+}
+
+static esp_err_t link_send(const char* key, int value)
+{
+    iot_data_t msg = {
+        .type = VAL_TYPE_INT,
+        .value = iot_value_int(value),
+        .channel = CANNEL_CONFIG,
+        .timestamp = 0,
+    };
+    strncpy(msg.device_id, s_device_id, sizeof(msg.device_id) - 1);
+    strncpy(msg.key, key, sizeof(msg.key) - 1);
+
+    uint8_t buffer[96];
+    size_t len = iot_data_encode_cbor(&msg, buffer, sizeof(buffer));
+    if (len == 0)
+    {
+        return ESP_FAIL;
+    }
+    // 控制消息走告警通道，不会排在遥测之后
+    return uart_tx_send(s_uart, buffer, len, UART_TX_PRIO_ALARM, UART_TX_KEY_NONE);
+}
+
+static bool link_wait(link_evt_type_t type, int* value, uint32_t timeout_ms)
+{
+    const int64_t deadline = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+    link_evt_t evt;
+
+    while (1)
+    {
+        const int64_t left_us = deadline - esp_timer_get_time();
+        if (left_us <= 0)
+        {
+            return false;
+        }
+        if (xQueueReceive(s_evt, &evt, pdMS_TO_TICKS(left_us / 1000) + 1) != pdTRUE)
+        {
+            return false;
+        }
+        if (evt.type == type)
+        {
+            *value = evt.value;
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief 等待已排队消息写出后切换波特率
+ */
+static esp_err_t link_switch(uint32_t baud)
+{
+    for (int i = 0; i < 20 && !uart_tx_idle(s_uart); i++)
+    {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    vTaskDelay(pdMS_TO_TICKS(10)); // 发送任务可能刚取出最后一批
+
+    esp_err_t err = uart_change_baudrate(s_uart, baud);
+    if (err == ESP_OK)
+    {
+        s_baud = baud;
+        xQueueReset(s_evt);
+    }
+    return err;
+}
+
+/**
+ * @brief 以当前波特率发送探测帧并等待回显
+ */
+static bool link_probe(void)
+{
+    vTaskDelay(pdMS_TO_TICKS(LINK_SWITCH_DELAY_MS));
+
+    for (int attempt = 0; attempt < LINK_PROBE_TRIES; attempt++)
+    {
+        const int nonce = (int)(esp_timer_get_time() & 0x7FFFFFFF);
+        int echo = 0;
+        if (link_send("ping", nonce) == ESP_OK &&
+            link_wait(LINK_EVT_PONG, &echo, LINK_PROBE_TIMEOUT_MS) && echo == nonce)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+esp_err_t link_init(uart_port_t uart_num, const char* device_id)
+{
+    s_uart = uart_num;
+    strncpy(s_device_id, device_id, sizeof(s_device_id) - 1);
+
+    if (s_evt == NULL)
+    {
+        s_evt = xQueueCreate(4, sizeof(link_evt_t));
+        if (s_evt == NULL)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    iot_data_set_wire_format(IOT_WIRE_LEGACY);
+    s_saved = link_load();
+    s_baud = LINK_BASE_BAUD;
+    s_ceiling = LINK_MAX_BAUD;
+    s_window_start = esp_timer_get_time();
+    s_window_errors = link_error_count();
+    ESP_LOGI(TAG, "Link init on UART%d, saved baud %lu", uart_num, s_saved);
+    return ESP_OK;
+}
+
+static esp_err_t link_negotiate_baud(void)
+{
+
+    // 上次协商成功的波特率先直接探测，省去报价往返
+    if (s_saved > LINK_BASE_BAUD && s_saved <= s_ceiling)
+    {
+        if (link_switch(s_saved) == ESP_OK && link_probe())
+        {
+            ESP_LOGI(TAG, "Resumed saved baud %lu", s_baud);
+            return ESP_OK;
+        }
+        ESP_LOGW(TAG, "Saved baud %lu failed probe, renegotiating", s_saved);
+    }
+    if (s_baud != LINK_BASE_BAUD)
+    {
+        link_switch(LINK_BASE_BAUD);
+    }
+
+    int agreed = 0;
+    if (link_send("baud", (int)s_ceiling) != ESP_OK ||
+        !link_wait(LINK_EVT_BAUD, &agreed, LINK_REPLY_TIMEOUT_MS))
+    {
+        ESP_LOGW(TAG, "No baud reply from host, staying at %d", LINK_BASE_BAUD);
+        return ESP_ERR_TIMEOUT;
+    }
+    if (agreed <= LINK_BASE_BAUD || (uint32_t)agreed > s_ceiling || !rate_supported((uint32_t)agreed))
+    {
+        ESP_LOGI(TAG, "Host declined upgrade (%d), staying at %d", agreed, LINK_BASE_BAUD);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (link_switch((uint32_t)agreed) == ESP_OK && link_probe())
+    {
+        link_save(s_baud);
+        ESP_LOGI(TAG, "Link upgraded to %lu baud", s_baud);
+        return ESP_OK;
+    }
+
+    // 主机在探测超时后同样会退回基础波特率
+    ESP_LOGW(TAG, "Probe at %d failed, falling back to %d", agreed, LINK_BASE_BAUD);
+    link_switch(LINK_BASE_BAUD);
+    s_ceiling = rate_below((uint32_t)agreed);
+    return ESP_FAIL;
+}
+
+/**
+ * @brief 在当前（高）波特率上通知主机降到 s_ceiling 以下，并在新波特率上探测
+ *
+ * @return ESP_OK 主机已应答（探测失败时已退回 9600 并安排重新报价）；ESP_ERR_TIMEOUT 主机未应答
+ */
+static esp_err_t link_downgrade(void)
+{
+    int agreed = 0;
+    bool replied = false;
+    for (int attempt = 0; attempt < LINK_PROBE_TRIES && !replied; attempt++)
+    {
+        replied = link_send("baud", (int)s_ceiling) == ESP_OK &&
+            link_wait(LINK_EVT_BAUD, &agreed, LINK_REPLY_TIMEOUT_MS);
+    }
+    if (!replied)
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    // 拒绝或非法应答：双方都回到基础波特率
+    if (agreed < LINK_BASE_BAUD || (uint32_t)agreed > s_ceiling || !rate_supported((uint32_t)agreed))
+    {
+        agreed = LINK_BASE_BAUD;
+    }
+
+    if (link_switch((uint32_t)agreed) == ESP_OK && link_probe())
+    {
+        if (s_baud > LINK_BASE_BAUD)
+        {
+            link_save(s_baud);
+        }
+        ESP_LOGI(TAG, "Link downgraded to %lu baud", s_baud);
+        return ESP_OK;
+    }
+
+    // 与初次协商相同：探测失败后主机在超时后同样退回基础波特率
+    ESP_LOGW(TAG, "Probe at %d failed after downgrade, falling back to %d", agreed, LINK_BASE_BAUD);
+    if (agreed > LINK_BASE_BAUD)
+    {
+        s_ceiling = rate_below((uint32_t)agreed);
+    }
+    link_switch(LINK_BASE_BAUD);
+    // 主机退回的时刻不确定，等其空闲超时后再以基础波特率报价
+    s_retry_at = esp_timer_get_time() + (int64_t)LINK_RETRY_MS * 1000;
+    return ESP_OK;
+}
+
+esp_err_t link_negotiate(void)
+{
+    if (s_evt == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 新会话从旧格式开始，主机应答后才切换为紧凑格式
+    iot_data_set_wire_format(IOT_WIRE_LEGACY);
+    const esp_err_t err = link_negotiate_baud();
+
+    // 报价消息以旧格式携带设备 ID，会话内其余消息不再重复发送
+    link_send("fmt", IOT_WIRE_COMPACT);
+    return err;
+}
+
+bool link_handle_message(const iot_data_t* msg)
+{
+    if (msg == NULL || msg->channel != CANNEL_CONFIG || msg->type != VAL_TYPE_INT)
+    {
+        return false;
+    }
+
+    if (strcmp(msg->key, "fmt") == 0)
+    {
+        // 主机选定的格式，不认识的值按旧格式处理
+        const int format = msg->value.i;
+        iot_data_set_wire_format(format == IOT_WIRE_COMPACT ? IOT_WIRE_COMPACT : IOT_WIRE_LEGACY);
+        ESP_LOGI(TAG, "Wire format -> %s", format == IOT_WIRE_COMPACT ? "compact" : "legacy");
+        return true;
+    }
+
+    link_evt_t evt;
+    if (strcmp(msg->key, "baud") == 0)
+    {
+        evt.type = LINK_EVT_BAUD;
+    }
+    else if (strcmp(msg->key, "pong") == 0)
+    {
+        evt.type = LINK_EVT_PONG;
+    }
+    else
+    {
+        return false;
+    }
+
+    evt.value = msg->value.i;
+    if (s_evt)
+    {
+        xQueueSend(s_evt, &evt, 0);
+    }
+    return true;
+}
+
+void link_service(void)
+{
+    const int64_t now = esp_timer_get_time();
+
+    // 高速链路保活，主机据此判断链路是否仍然可用
+    if (s_baud > LINK_BASE_BAUD && now >= s_keepalive_at)
+    {
+        s_keepalive_at = now + (int64_t)LINK_KEEPALIVE_MS * 1000;
+        link_send("ka", 0);
+    }
+
+    if (s_retry_at && now >= s_retry_at)
+    {
+        s_retry_at = 0;
+        if (link_negotiate_baud() == ESP_ERR_TIMEOUT && s_baud == LINK_BASE_BAUD)
+        {
+            s_retry_at = esp_timer_get_time() + (int64_t)LINK_RETRY_MS * 1000;
+        }
+        return;
+    }
+
+    if (now - s_window_start < (int64_t)LINK_HEALTH_WINDOW_MS * 1000)
+    {
+        return;
+    }
+
+    const uint32_t errors = link_error_count();
+    const uint32_t delta = errors - s_window_errors;
+    s_window_errors = errors;
+    s_window_start = now;
+
+    if (s_baud > LINK_BASE_BAUD && delta > LINK_HEALTH_MAX_ERRORS)
+    {
+        // 高速下误码过多：降低报价上限、清除记忆，先在当前波特率通知主机
+        ESP_LOGW(TAG, "%lu bad frames at %lu baud, downgrading", delta, s_baud);
+        s_ceiling = rate_below(s_baud);
+        link_save(0);
+        if (link_downgrade() != ESP_OK)
+        {
+            // 主机收不到：它在 LINK_HOST_IDLE_MS 无有效帧后自行退回 9600，届时重新报价
+            ESP_LOGW(TAG, "No downgrade reply, waiting for host fallback to %d", LINK_BASE_BAUD);
+            link_switch(LINK_BASE_BAUD);
+            s_retry_at = esp_timer_get_time() + (int64_t)LINK_RETRY_MS * 1000;
+        }
+        s_window_errors = link_error_count();
+        s_window_start = esp_timer_get_time();
+    }
+}
+
+uint32_t link_current_baud(void)
+{
+    return s_baud;
+}
@@ -0,0 +1,65 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+#ifndef HEALTHY_MCU_LINK_H
+#define HEALTHY_MCU_LINK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "driver/uart.h"
+#include "esp_err.h"
+#include "vars.h"
+
+/*
+ * 上位机链路波特率协商（CANNEL_CONFIG 通道上的 iot_data_t 消息）：
+ *   设备 -> 主机  key="baud" val=设备支持的最高波特率
+ *   主机 -> 设备  key="baud" val=双方都支持的波特率（<= 设备报价，0 表示拒绝）
+ *   双方切换到新波特率
+ *   设备 -> 主机  key="ping" val=随机数
+ *   主机 -> 设备  key="pong" val=同一随机数
+ * 探测失败时双方各自在超时后退回 9600。成功的波特率写入 NVS，下次启动直接探测。
+ * 运行中降速（设备检测到误码过多）：
+ *   设备 -> 主机  以当前波特率发送 key="baud" val=降低后的上限
+ *   主机 -> 设备  按上面的规则应答（0 表示双方直接退回 9600），之后同样切换并探测
+ *   无应答时设备退回 9600，每 LINK_RETRY_MS 以 9600 重新报价
+ * 高于 9600 时设备每 LINK_KEEPALIVE_MS 发送 key="ka"（主机无需应答）；
+ * 主机连续 LINK_HOST_IDLE_MS 未收到有效帧须自行退回 9600，保证降速消息丢失时链路仍能恢复。
+ * 随后协商线路格式（旧格式发送，携带一次设备 ID）：
+ *   设备 -> 主机  key="fmt" val=1（支持紧凑格式）
+ *   主机 -> 设备  key="fmt" val=1 切换为紧凑格式 / 0 保持旧格式
+ */
+
+#define LINK_BASE_BAUD          9600
+#define LINK_MAX_BAUD           921600
+#define LINK_KEEPALIVE_MS       1000    // 高速链路上设备发送保活消息的周期
+#define LINK_HOST_IDLE_MS       5000    // 主机无有效帧即退回基础波特率的时长
+#define LINK_RETRY_MS           (LINK_HOST_IDLE_MS + 1000)  // 降速失败后以基础波特率重新报价的间隔
+
+/**
+ * @brief 初始化链路管理，读取上次协商结果
+ *
+ * @param uart_num 已以 LINK_BASE_BAUD 初始化并启用帧模式、发送调度的端口
+ * @param device_id 消息中携带的设备 ID
+ */
+esp_err_t link_init(uart_port_t uart_num, const char* device_id);
+
+/**
+ * @brief 阻塞执行协商，失败时保持/退回 LINK_BASE_BAUD
+ */
+esp_err_t link_negotiate(void);
+
+/**
+ * @brief 在接收回调中调用，属于链路控制的消息返回 true（已消费）
+ */
+bool link_handle_message(const iot_data_t* msg);
+
+/**
+ * @brief 周期调用：高速链路上发送保活；帧错误率过高时先在当前波特率通知主机降速
+ */
+void link_service(void);
+
+uint32_t link_current_baud(void);
+
+#endif //HEALTHY_MCU_LINK_H
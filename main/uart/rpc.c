@@ -0,0 +1,292 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+#include "rpc.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "uart_tx.h"
+
+static const char* TAG = "RPC";
+
+typedef struct
+{
+    char key[sizeof(((iot_data_t*)0)->key)];
+    rpc_handler_t handler;
+    void* ctx;
+    uint32_t timeout_ms;
+} rpc_method_t;
+
+typedef struct
+{
+    int method;
+    uint32_t rid;
+    int64_t deadline_us;
+    rpc_value_t arg;
+} rpc_slot_t;
+
+static rpc_method_t s_methods[RPC_MAX_METHODS];
+static int s_method_count = 0;
+static portMUX_TYPE s_method_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static rpc_slot_t s_slots[RPC_MAX_PENDING];
+static QueueHandle_t s_free = NULL;     // 空闲槽索引
+static QueueHandle_t s_work = NULL;     // 待执行槽索引
+
+static uart_port_t s_uart = UART_NUM_1;
+static char s_device_id[18];
+static rpc_stats_t s_stats;
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#define RPC_STAT_INC(field) do { portENTER_CRITICAL(&s_stats_lock); s_stats.field++; portEXIT_CRITICAL(&s_stats_lock); } while (0)
+
+/* -------------------------------------------------------------------------- */
+/*                                   响应                                      */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief 应答走不可丢弃的 REPLY 通道；队列满时工作任务持有槽位等待（反压），
+ *        接收回调中（I/O 任务负责写出，不能等待）只尝试一次
+ */
+static void rpc_send(const char* key, uint32_t rid, const rpc_value_t* value, bool may_block)
+{
+    iot_data_t resp = {
+        .type = value->type,
+        .channel = CANNEL_FUNCTION,
+        .timestamp = (uint32_t)(esp_timer_get_time() / 1000000),
+        .rid = rid,
+    };
+    strncpy(resp.device_id, s_device_id, sizeof(resp.device_id) - 1);
+    strncpy(resp.key, key, sizeof(resp.key) - 1);
+    switch (value->type)
+    {
+    case VAL_TYPE_FLOAT:
+        resp.value = iot_value_float(value->v.f);
+        break;
+    case VAL_TYPE_BOOL:
+        resp.value = iot_value_bool(value->v.b);
+        break;
+    case VAL_TYPE_STR:
+        resp.value = iot_value_str(value->v.s);
+        break;
+    default:
+        resp.value = iot_value_int(value->v.i);
+        break;
+    }
+
+    uint8_t buffer[128];
+    const size_t len = iot_data_encode_cbor(&resp, buffer, sizeof(buffer));
+    esp_err_t err = len == 0 ? ESP_ERR_INVALID_SIZE : ESP_ERR_NO_MEM;
+    if (len > 0)
+    {
+        const TickType_t start = xTaskGetTickCount();
+        while ((err = uart_tx_send(s_uart, buffer, len, UART_TX_PRIO_REPLY, UART_TX_KEY_NONE)) == ESP_ERR_NO_MEM &&
+               may_block && xTaskGetTickCount() - start < pdMS_TO_TICKS(RPC_REPLY_QUEUE_MS))
+        {
+            vTaskDelay(1);
+        }
+    }
+    if (err != ESP_OK)
+    {
+        RPC_STAT_INC(reply_drops);
+        ESP_LOGW(TAG, "Dropped response rid=%lu: %s", rid, esp_err_to_name(err));
+    }
+}
+
+static void rpc_send_error(const char* method, uint32_t rid, const char* reason, bool may_block)
+{
+    rpc_value_t err = {.type = VAL_TYPE_STR};
+    snprintf(err.v.s, sizeof(err.v.s), "%s:%s", method, reason);
+    rpc_send("err", rid, &err, may_block);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  工作任务                                    */
+/* -------------------------------------------------------------------------- */
+
+static void rpc_worker_task(void* arg)
+{
+    uint8_t idx;
+
+    while (1)
+    {
+        if (xQueueReceive(s_work, &idx, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+
+        rpc_slot_t* slot = &s_slots[idx];
+        const rpc_method_t* method = &s_methods[slot->method];
+
+        if (esp_timer_get_time() > slot->deadline_us)
+        {
+            // 排队过久，结果对主机已无意义
+            RPC_STAT_INC(timeouts);
+            rpc_send_error(method->key, slot->rid, "timeout", true);
+        }
+        else
+        {
+            rpc_value_t result = {.type = VAL_TYPE_INT};
+            if (method->handler(&slot->arg, &result, method->ctx) == ESP_OK)
+            {
+                RPC_STAT_INC(completed);
+                rpc_send(method->key, slot->rid, &result, true);
+            }
+            else
+            {
+                RPC_STAT_INC(failed);
+                rpc_send_error(method->key, slot->rid, "failed", true);
+            }
+        }
+
+        // 应答入队后才归还槽位，发送积压时新请求会收到 busy 而不是被静默丢弃
+        xQueueSend(s_free, &idx, 0);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  公共接口                                    */
+/* -------------------------------------------------------------------------- */
+
+esp_err_t rpc_init(uart_port_t uart_num, const char* device_id)
+{
+    if (s_work != NULL)
+    {
+        return ESP_OK;
+    }
+
+    s_uart = uart_num;
+    strncpy(s_device_id, device_id, sizeof(s_device_id) - 1);
+
+    s_free = xQueueCreate(RPC_MAX_PENDING, sizeof(uint8_t));
+    s_work = xQueueCreate(RPC_MAX_PENDING, sizeof(uint8_t));
+    if (s_free == NULL || s_work == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    for (uint8_t i = 0; i < RPC_MAX_PENDING; i++)
+    {
+        xQueueSend(s_free, &i, 0);
+    }
+
+    for (int i = 0; i < RPC_WORKERS; i++)
+    {
+        char name[16];
+        snprintf(name, sizeof(name), "rpc_worker_%d", i);
+        if (xTaskCreate(rpc_worker_task, name, 4096, NULL, 5, NULL) != pdPASS)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    ESP_LOGI(TAG, "RPC started: %d workers, %d pending", RPC_WORKERS, RPC_MAX_PENDING);
+    return ESP_OK;
+}
+
+esp_err_t rpc_register(const char* key, rpc_handler_t handler, void* ctx, uint32_t timeout_ms)
+{
+    if (key == NULL || handler == NULL || strlen(key) >= sizeof(s_methods[0].key))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = ESP_OK;
+    portENTER_CRITICAL(&s_method_lock);
+    if (s_method_count >= RPC_MAX_METHODS)
+    {
+        err = ESP_ERR_NO_MEM;
+    }
+    else
+    {
+        rpc_method_t* m = &s_methods[s_method_count];
+        strcpy(m->key, key);
+        m->handler = handler;
+        m->ctx = ctx;
+        m->timeout_ms = timeout_ms ? timeout_ms : RPC_DEFAULT_TIMEOUT_MS;
+        s_method_count++;
+    }
+    portEXIT_CRITICAL(&s_method_lock);
+    return err;
+}
+
+static int rpc_find(const char* key)
+{
+    for (int i = 0; i < s_method_count; i++)
+    {
+        if (strcmp(s_methods[i].key, key) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool rpc_submit(const iot_data_t* request)
+{
+    if (request == NULL || request->rid == 0 || s_work == NULL)
+    {
+        return false;
+    }
+    RPC_STAT_INC(requests);
+
+    const int method = rpc_find(request->key);
+    if (method < 0)
+    {
+        RPC_STAT_INC(unknown);
+        rpc_send_error(request->key, request->rid, "unknown", false);
+        return true;
+    }
+
+    uint8_t idx;
+    if (xQueueReceive(s_free, &idx, 0) != pdTRUE)
+    {
+        RPC_STAT_INC(busy);
+        rpc_send_error(request->key, request->rid, "busy", false);
+        return true;
+    }
+
+    // 参数拷贝进槽内，借用的长串在接收回调返回后即失效
+    rpc_slot_t* slot = &s_slots[idx];
+    slot->method = method;
+    slot->rid = request->rid;
+    slot->deadline_us = esp_timer_get_time() + (int64_t)s_methods[method].timeout_ms * 1000;
+    memset(&slot->arg, 0, sizeof(slot->arg));
+    slot->arg.type = request->type;
+    switch (request->type)
+    {
+    case VAL_TYPE_INT:
+        slot->arg.v.i = request->value.i;
+        break;
+    case VAL_TYPE_FLOAT:
+        slot->arg.v.f = request->value.f;
+        break;
+    case VAL_TYPE_BOOL:
+        slot->arg.v.b = request->value.b;
+        break;
+    case VAL_TYPE_STR:
+        {
+            const size_t n = request->value.len < sizeof(slot->arg.v.s) - 1 ? request->value.len : sizeof(slot->arg.v.s) - 1;
+            memcpy(slot->arg.v.s, iot_value_data(&request->value), n);
+            break;
+        }
+    default:
+        break;
+    }
+
+    xQueueSend(s_work, &idx, 0);
+    return true;
+}
+
+void rpc_get_stats(rpc_stats_t* out)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
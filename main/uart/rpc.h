@@ -0,0 +1,89 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+#ifndef HEALTHY_MCU_RPC_H
+#define HEALTHY_MCU_RPC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "driver/uart.h"
+#include "esp_err.h"
+#include "vars.h"
+
+/*
+ * 基于 iot_data_t 的请求/响应 RPC：
+ *   请求：key=方法名，rid=主机分配的请求 ID（非 0），val=参数
+ *   响应：key=方法名，rid 原样返回，val=结果；出错时 key="err"，val="<方法名>:<原因>"
+ * 主机可同时挂起多个请求，响应按完成顺序返回（可能乱序），以 rid 匹配。
+ */
+
+#define RPC_MAX_METHODS     16
+#define RPC_MAX_PENDING     16      // 同时挂起的请求数
+#define RPC_WORKERS         2       // 工作任务数，慢方法不会阻塞其他请求
+#define RPC_STR_MAX         32
+#define RPC_DEFAULT_TIMEOUT_MS 1000
+#define RPC_REPLY_QUEUE_MS  2000    // 工作任务等待发送队列接纳应答的上限（9600 波特率下约可写出 2KB）
+
+/**
+ * @brief 请求参数 / 响应结果
+ */
+typedef struct
+{
+    val_type_t type;
+    union
+    {
+        int i;
+        float f;
+        bool b;
+        char s[RPC_STR_MAX];
+    } v;
+} rpc_value_t;
+
+/**
+ * @brief 方法处理函数，运行于 RPC 工作任务
+ *
+ * @param arg 请求参数
+ * @param result 输出结果
+ * @param ctx 注册时的上下文
+ */
+typedef esp_err_t (*rpc_handler_t)(const rpc_value_t* arg, rpc_value_t* result, void* ctx);
+
+typedef struct
+{
+    uint32_t requests;
+    uint32_t completed;
+    uint32_t timeouts;      // 排队超过截止时间未执行
+    uint32_t busy;          // 挂起数已满被拒绝
+    uint32_t unknown;       // 未注册的方法
+    uint32_t failed;        // 处理函数返回错误
+    uint32_t reply_drops;   // 发送队列始终无空位、未能发出的应答（含错误应答）
+} rpc_stats_t;
+
+/**
+ * @brief 启动 RPC 工作任务
+ *
+ * @param uart_num 响应发送的端口（经发送调度）
+ * @param device_id 响应中携带的设备 ID
+ */
+esp_err_t rpc_init(uart_port_t uart_num, const char* device_id);
+
+/**
+ * @brief 注册方法
+ *
+ * @param key 方法名（iot_data_t.key）
+ * @param handler 处理函数
+ * @param ctx 上下文
+ * @param timeout_ms 请求在队列中的最长等待，0 使用默认值
+ */
+esp_err_t rpc_register(const char* key, rpc_handler_t handler, void* ctx, uint32_t timeout_ms);
+
+/**
+ * @brief 在接收回调中提交请求，拷贝后立即返回；rid 为 0 的消息返回 false
+ */
+bool rpc_submit(const iot_data_t* request);
+
+void rpc_get_stats(rpc_stats_t* out);
+
+#endif //HEALTHY_MCU_RPC_H
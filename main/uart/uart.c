@@ -11,6 +11,11 @@
 // 包含 FreeRTOS 的基础头文件（任务、延时等 API）
 #include "freertos/FreeRTOS.h"    // FreeRTOS 基本类型与宏
 #include "freertos/task.h"        // xTaskCreate / vTaskDelay 等任务 API
+#include "freertos/queue.h"       // 驱动事件队列与队列集
+#include "freertos/semphr.h"      // 发送调度信号量
+
+// 高精度计时，统计反应器单次处理耗时
+#include "esp_timer.h"
 
 // ESP 平台基础头文件（系统、日志）
 #include "esp_log.h"              // ESP_LOGx 系列日志宏
@@ -24,12 +29,44 @@
 // GPIO 定义（若需控制引脚，例如 rs485 的 DE）
 #include "driver/gpio.h"          // gpio 控制（示例中未直接使用，但通常会需要）
 
+// 帧编解码（COBS + CRC16）
+#include "frame.h"
+
+// 发送调度，由 I/O 任务驱动写出
+#include "uart_tx.h"
+
 // 定义接收缓冲区大小（字节）
 static const int RX_BUF_SIZE = 1024; // 用于 uart_read_bytes 的缓冲区大小
 
+// 驱动 TX 环大小：写入拷贝进环即返回，不再等待逐字节发送完毕
+static const int TX_BUF_SIZE = 2048;
+
 // UART通道最大数量
 #define UART_CHANNEL_MAX 3
 
+// 驱动事件队列长度与终止符位置队列长度
+#define UART_EVENT_QUEUE_LEN   20
+#define UART_PATTERN_QUEUE_LEN 20
+
+// 接收超时（符号数）：线路空闲这么久即产生 UART_DATA 事件
+#define UART_RX_TOUT_SYMBOLS   3
+
+// 每通道静态接收环大小（2 的幂）与跨环尾的整行线性化缓冲
+#define UART_RX_RING_SIZE      1024
+#define UART_RX_RING_MASK      (UART_RX_RING_SIZE - 1)
+#define UART_LINE_MAX          256
+
+// 队列集容量：每通道事件队列长度 + 发送信号量
+#define UART_IO_SET_LEN        (UART_CHANNEL_MAX * (UART_EVENT_QUEUE_LEN + 1))
+
+// 驱动 TX 环已满、仍有消息待发时的重试间隔；不足一个 tick 时按一个 tick 等待，避免忙等
+#define UART_IO_TX_RETRY_MS    5
+#define UART_IO_TX_RETRY_TICKS (pdMS_TO_TICKS(UART_IO_TX_RETRY_MS) > 0 ? pdMS_TO_TICKS(UART_IO_TX_RETRY_MS) : 1)
+
+// 切换波特率前等待已写入字节发完、以及等待 I/O 任务完成接收复位的上限
+#define UART_BAUD_TX_DONE_MS   200
+#define UART_BAUD_RESET_MS     50
+
 // UART通道配置结构体
 typedef struct {
     uart_port_t uart_num;                           // UART端口号
@@ -38,13 +75,37 @@ typedef struct {
     uint32_t baud_rate;                             // 波特率
     uart_receive_callback_t callback;               // 接收回调函数
     uint8_t terminator;                             // 接收终止符
-    TaskHandle_t rx_task_handle;                    // 接收任务句柄
+    SemaphoreHandle_t tx_signal;                    // 发送调度信号（已加入队列集）
     bool is_initialized;                            // 是否已初始化
+    bool framed;                                    // 是否启用 COBS 帧模式
+    QueueHandle_t event_queue;                      // 驱动事件队列
+    uart_frame_decoder_t decoder;                   // 流式帧解码器
+    uint32_t rx_overflows;                          // FIFO / 驱动缓冲溢出次数
+    uint32_t rx_breaks;                             // 线路 break 次数
+    uint32_t rx_errors;                             // 帧 / 校验错误次数
+    uint32_t rx_ring_full;                          // 接收环满、数据滞留在驱动缓冲的次数
+    uint32_t rx_stale;                              // 重新同步后待丢弃的过期事件数
+    volatile bool rx_refill_posted;                 // 已投递补读事件、尚未被 I/O 任务处理
+    volatile bool rx_reset_pending;                 // 其他任务请求的接收复位，由 I/O 任务执行
+    uart_slice_callback_t slice_callback;           // 零拷贝切片回调
+    void* slice_ctx;                                // 切片回调上下文
+    volatile uint32_t ring_head;                    // 写位置（仅接收任务修改，自由递增）
+    volatile uint32_t ring_tail;                    // 释放位置（消费者与重新同步修改，须持 uart_ring_lock）
+    uint8_t ring[UART_RX_RING_SIZE];                // 接收环
+    uint8_t line[UART_LINE_MAX];                    // 跨环尾的行拼接缓冲
 } uart_channel_t;
 
-// UART通道数组
+// UART通道数组（静态存储，I/O 任务直接持有其中元素的指针）
 static uart_channel_t uart_channels[UART_CHANNEL_MAX] = {0};
 
+// ring_tail 有两个写者：其他任务中的 uart_rx_release 与 I/O 任务中的重新同步，二者互斥
+static portMUX_TYPE uart_ring_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 所有通道共用一个 I/O 任务，阻塞在覆盖全部事件队列与发送信号的队列集上
+static QueueSetHandle_t uart_io_set = NULL;
+static TaskHandle_t uart_io_task_handle = NULL;
+static uart_io_stats_t uart_io_stats = {0};
+
 // 日志标签
 static const char *UART_TOOL_TAG = "UART_TOOL";
 
@@ -65,57 +126,386 @@ static int find_uart_channel(uart_port_t uart_num)
 }
 
 /**
- * @brief UART接收任务
+ * @brief 帧解码完成回调，按帧的真实长度交给用户回调
+ */
+static void uart_frame_received(const uint8_t* payload, size_t length, void* ctx)
+{
+    uart_channel_t* channel = (uart_channel_t*)ctx;
+    if (channel->callback) {
+        channel->callback(payload, length);
+    }
+}
+
+/**
+ * @brief 从驱动缓冲直接读入接收环的空闲区（最多两段）
+ *
+ * @param channel 通道上下文
+ * @param want 期望读取的字节数
+ * @return size_t 实际读入的字节数
+ */
+static size_t uart_ring_fill(uart_channel_t* channel, size_t want)
+{
+    size_t total = 0;
+
+    while (want > 0) {
+        const uint32_t head = channel->ring_head;
+        const size_t free_bytes = UART_RX_RING_SIZE - (head - channel->ring_tail);
+        if (free_bytes == 0) {
+            // 消费者尚未释放，剩余数据留在驱动缓冲中
+            channel->rx_ring_full++;
+            break;
+        }
+
+        size_t contiguous = UART_RX_RING_SIZE - (head & UART_RX_RING_MASK);
+        if (contiguous > free_bytes) contiguous = free_bytes;
+        if (contiguous > want) contiguous = want;
+
+        const int rxBytes = uart_read_bytes(channel->uart_num, &channel->ring[head & UART_RX_RING_MASK], contiguous, 0);
+        if (rxBytes <= 0) {
+            break;
+        }
+        channel->ring_head = head + rxBytes;
+        want -= rxBytes;
+        total += rxBytes;
+    }
+
+    return total;
+}
+
+/**
+ * @brief 取得待处理数据的一到两个连续切片
+ *
+ * @param channel 通道上下文
+ * @param slices 输出切片
+ * @return int 切片个数（0~2）
+ */
+static int uart_ring_slices(const uart_channel_t* channel, uart_slice_t slices[2])
+{
+    const uint32_t tail = channel->ring_tail;
+    const size_t pending = channel->ring_head - tail;
+    if (pending == 0) {
+        return 0;
+    }
+
+    const size_t offset = tail & UART_RX_RING_MASK;
+    const size_t first = UART_RX_RING_SIZE - offset;
+    slices[0].data = &channel->ring[offset];
+    if (pending <= first) {
+        slices[0].length = pending;
+        return 1;
+    }
+
+    slices[0].length = first;
+    slices[1].data = channel->ring;
+    slices[1].length = pending - first;
+    return 2;
+}
+
+static void uart_ring_release(uart_channel_t* channel, size_t length)
+{
+    portENTER_CRITICAL(&uart_ring_lock);
+    const size_t pending = channel->ring_head - channel->ring_tail;
+    channel->ring_tail += length > pending ? pending : length;
+    portEXIT_CRITICAL(&uart_ring_lock);
+}
+
+/**
+ * @brief 将接收环中的待处理数据按通道模式交付
+ *
+ * @param channel 通道上下文
+ * @param is_line 待处理数据是否恰好为一整行（终止符模式）
+ */
+static void uart_rx_dispatch(uart_channel_t* channel, bool is_line)
+{
+    uart_slice_t slices[2];
+    const int count = uart_ring_slices(channel, slices);
+    if (count == 0) {
+        return;
+    }
+
+    if (channel->framed) {
+        // 帧模式：切片直接喂给解码器，一帧可能跨多次读取
+        for (int i = 0; i < count; i++) {
+            uart_frame_feed(&channel->decoder, slices[i].data, slices[i].length, uart_frame_received, channel);
+        }
+        uart_ring_release(channel, slices[0].length + (count > 1 ? slices[1].length : 0));
+        return;
+    }
+
+    if (channel->slice_callback) {
+        // 零拷贝：回调通过 uart_rx_release 释放已消费部分，未释放的数据下次连同新数据再次交付
+        channel->slice_callback(channel->uart_num, slices, count, channel->slice_ctx);
+        return;
+    }
+
+    size_t total = slices[0].length + (count > 1 ? slices[1].length : 0);
+    if (channel->callback) {
+        if (count == 2 && is_line && total <= UART_LINE_MAX) {
+            // 整行跨越环尾时才拼接，保证回调收到完整一行
+            memcpy(channel->line, slices[0].data, slices[0].length);
+            memcpy(channel->line + slices[0].length, slices[1].data, slices[1].length);
+            channel->callback(channel->line, total);
+        } else {
+            for (int i = 0; i < count; i++) {
+                channel->callback(slices[i].data, slices[i].length);
+            }
+        }
+    }
+    uart_ring_release(channel, total);
+}
+
+/**
+ * @brief 驱动缓冲溢出后丢弃残余数据，避免解析错位
+ */
+static void uart_rx_resync(uart_channel_t* channel)
+{
+    uart_flush_input(channel->uart_num);
+    // 事件队列已加入队列集，不能 xQueueReset，只能按序取出后丢弃
+    channel->rx_stale = uxQueueMessagesWaiting(channel->event_queue);
+    portENTER_CRITICAL(&uart_ring_lock);
+    channel->ring_tail = channel->ring_head;
+    portEXIT_CRITICAL(&uart_ring_lock);
+    channel->rx_refill_posted = false;
+    uart_frame_decoder_reset(&channel->decoder);
+    if (!channel->framed) {
+        uart_pattern_queue_reset(channel->uart_num, UART_PATTERN_QUEUE_LEN);
+    }
+}
+
+/**
+ * @brief 通道接收状态机：处理一个驱动事件
  * 
- * @param arg 任务参数（指向通道索引）
+ * @param channel 通道上下文
+ * @param event 驱动事件
  */
-static void uart_rx_task(void *arg)
+static void uart_channel_handle_event(uart_channel_t* channel, const uart_event_t* event)
 {
-    int channel_index = *(int*)arg;
-    uart_channel_t* channel = &uart_channels[channel_index];
-    
-    // 为接收分配缓冲区
-    uint8_t* data = (uint8_t*) malloc(RX_BUF_SIZE + 1);
-    if (data == NULL) {
-        ESP_LOGE(UART_TOOL_TAG, "Failed to allocate memory for UART RX buffer");
-        vTaskDelete(NULL);
+    if (channel->rx_reset_pending) {
+        // 复位请求之前的事件与数据都属于旧波特率，一并丢弃
+        channel->rx_reset_pending = false;
+        uart_rx_resync(channel);
+        return;
     }
 
-    ESP_LOGI(UART_TOOL_TAG, "UART RX task started for UART%d", channel->uart_num);
+    if (channel->rx_stale > 0) {
+        // 重新同步前已入队的事件，对应的数据已被清空
+        channel->rx_stale--;
+        return;
+    }
 
-    while (1) {
-        // 从指定UART读取数据
-        const int rxBytes = uart_read_bytes(channel->uart_num, data, RX_BUF_SIZE, 100 / portTICK_PERIOD_MS);
-
-        if (rxBytes > 0) {
-            // 查找终止符
-            bool terminator_found = false;
-            int data_length = rxBytes;
-            
-            for (int i = 0; i < rxBytes; i++) {
-                if (data[i] == channel->terminator) {
-                    terminator_found = true;
-                    data_length = i + 1; // 包括终止符
-                    break;
+    switch (event->type) {
+        case UART_DATA:
+            channel->rx_refill_posted = false;
+            // 帧模式逐字节重组；终止符模式等待 UART_PATTERN_DET，只在缓冲将满时按原始块交付
+            if (channel->framed || channel->slice_callback) {
+                uart_ring_fill(channel, event->size);
+                uart_rx_dispatch(channel, false);
+            } else {
+                size_t buffered = 0;
+                uart_get_buffered_data_len(channel->uart_num, &buffered);
+                if (buffered >= (size_t)RX_BUF_SIZE) {
+                    uart_ring_fill(channel, buffered);
+                    uart_rx_dispatch(channel, false);
                 }
             }
-            
-            // 如果设置了回调函数，则调用它
-            if (channel->callback) {
-                channel->callback(data, data_length);
+            break;
+
+        case UART_PATTERN_DET: {
+            // 终止符位置由硬件记录，读取到终止符为止（包括终止符）恰好是一条消息
+            const int pos = uart_pattern_pop_pos(channel->uart_num);
+            if (pos < 0) {
+                // 位置队列已满丢失记录，只能整体清空重新同步
+                channel->rx_overflows++;
+                uart_rx_resync(channel);
+                break;
             }
-            
-            // 如果找到了终止符，记录日志
-            if (terminator_found) {
-                ESP_LOGD(UART_TOOL_TAG, "Received data with terminator on UART%d", channel->uart_num);
+            uart_ring_fill(channel, pos + 1);
+            uart_rx_dispatch(channel, true);
+            ESP_LOGD(UART_TOOL_TAG, "Received data with terminator on UART%d", channel->uart_num);
+            break;
+        }
+
+        case UART_FIFO_OVF:
+        case UART_BUFFER_FULL:
+            channel->rx_overflows++;
+            ESP_LOGW(UART_TOOL_TAG, "UART%d RX overflow (%lu)", channel->uart_num, channel->rx_overflows);
+            uart_rx_resync(channel);
+            break;
+
+        case UART_BREAK:
+            // 线路 break 通常意味着对端复位，丢弃半帧
+            channel->rx_breaks++;
+            uart_frame_decoder_reset(&channel->decoder);
+            break;
+
+        case UART_FRAME_ERR:
+        case UART_PARITY_ERR:
+            channel->rx_errors++;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief 查找队列集成员所属的通道
+ * 
+ * @param member 被唤醒的队列集成员
+ * @param is_tx 输出：是否为发送信号
+ * @return uart_channel_t* 通道，未找到返回 NULL
+ */
+static uart_channel_t* uart_io_find_member(QueueSetMemberHandle_t member, bool* is_tx)
+{
+    for (int i = 0; i < UART_CHANNEL_MAX; i++) {
+        uart_channel_t* channel = &uart_channels[i];
+        if (!channel->is_initialized) {
+            continue;
+        }
+        if (member == (QueueSetMemberHandle_t)channel->event_queue) {
+            *is_tx = false;
+            return channel;
+        }
+        if (channel->tx_signal && member == (QueueSetMemberHandle_t)channel->tx_signal) {
+            *is_tx = true;
+            return channel;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 有通道的驱动 TX 环已满、消息仍在排队
+ */
+static bool uart_io_tx_pending(void)
+{
+    for (int i = 0; i < UART_CHANNEL_MAX; i++) {
+        if (uart_channels[i].is_initialized && uart_channels[i].tx_signal &&
+            !uart_tx_idle(uart_channels[i].uart_num)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 所有通道共用的 I/O 任务：队列集唤醒后分发到对应通道的接收状态机或发送调度
+ * 
+ * @param arg 未使用
+ */
+static void uart_io_task(void *arg)
+{
+    bool tx_pending = false;
+
+    ESP_LOGI(UART_TOOL_TAG, "UART I/O task started");
+
+    while (1) {
+        // 发送积压时限时等待，TX 环腾出空间后继续写出，不阻塞接收
+        const TickType_t wait = tx_pending ? UART_IO_TX_RETRY_TICKS : portMAX_DELAY;
+        QueueSetMemberHandle_t member = xQueueSelectFromSet(uart_io_set, wait);
+        const int64_t start = esp_timer_get_time();
+        uart_io_stats.wakeups++;
+
+        bool is_tx = false;
+        uart_channel_t* channel = member ? uart_io_find_member(member, &is_tx) : NULL;
+
+        if (channel && !is_tx) {
+            uart_event_t event;
+            // 队列集每次通知对应恰好一个事件
+            if (xQueueReceive(channel->event_queue, &event, 0) == pdTRUE) {
+                uart_io_stats.rx_events++;
+                uart_channel_handle_event(channel, &event);
+            }
+        } else if (channel && is_tx) {
+            xSemaphoreTake(channel->tx_signal, 0);
+            uart_io_stats.tx_flushes++;
+            uart_tx_flush(channel->uart_num);
+        } else if (tx_pending) {
+            uart_io_stats.tx_retries++;
+            for (int i = 0; i < UART_CHANNEL_MAX; i++) {
+                if (uart_channels[i].is_initialized && uart_channels[i].tx_signal) {
+                    uart_tx_flush(uart_channels[i].uart_num);
+                }
             }
         }
+        tx_pending = uart_io_tx_pending();
+
+        const uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+        uart_io_stats.busy_us += elapsed;
+        if (elapsed > uart_io_stats.max_dispatch_us) {
+            uart_io_stats.max_dispatch_us = elapsed;
+        }
     }
 
-    free(data);
     vTaskDelete(NULL);
 }
 
+/**
+ * @brief 首次初始化通道时创建队列集与 I/O 任务
+ * 
+ * @return esp_err_t ESP-IDF错误码
+ */
+static esp_err_t uart_io_start(void)
+{
+    if (uart_io_task_handle != NULL) {
+        return ESP_OK;
+    }
+
+    if (uart_io_set == NULL) {
+        uart_io_set = xQueueCreateSet(UART_IO_SET_LEN);
+        if (uart_io_set == NULL) {
+            ESP_LOGE(UART_TOOL_TAG, "Failed to create UART queue set");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    BaseType_t task_result = xTaskCreate(
+        uart_io_task,
+        "uart_io",
+        4096, // 回调中会编码并回发帧，需要额外栈空间
+        NULL,
+        12, // 阻塞在队列集上，无需最高优先级轮询
+        &uart_io_task_handle
+    );
+    if (task_result != pdTRUE) {
+        ESP_LOGE(UART_TOOL_TAG, "Failed to create UART I/O task");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 将队列加入队列集，加入前必须为空
+ */
+static esp_err_t uart_io_watch(QueueSetMemberHandle_t member)
+{
+    if (xQueueAddToSet(member, uart_io_set) != pdPASS) {
+        // 尚未加入队列集，可以安全清空后重试
+        xQueueReset((QueueHandle_t)member);
+        if (xQueueAddToSet(member, uart_io_set) != pdPASS) {
+            return ESP_FAIL;
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 根据通道模式配置硬件模式检测
+ *
+ * @param channel 通道上下文
+ */
+static void uart_apply_pattern(uart_channel_t* channel)
+{
+    // 帧模式与切片模式按字节流处理，不需要终止符定位
+    if (channel->framed || channel->slice_callback) {
+        uart_disable_pattern_det_intr(channel->uart_num);
+        return;
+    }
+
+    uart_enable_pattern_det_baud_intr(channel->uart_num, (char)channel->terminator, 1, 9, 0, 0);
+    uart_pattern_queue_reset(channel->uart_num, UART_PATTERN_QUEUE_LEN);
+}
+
 /**
  * @brief 初始化UART通道
  * 
@@ -158,13 +548,27 @@ esp_err_t uart_init(uart_port_t uart_num, gpio_num_t tx_pin, gpio_num_t rx_pin,
         .source_clk = UART_SCLK_DEFAULT,            // 时钟源，使用默认
     };
 
+    esp_err_t err = uart_io_start();
+    if (err != ESP_OK) {
+        return err;
+    }
+
     // 安装 UART 驱动
-    esp_err_t err = uart_driver_install(uart_num, RX_BUF_SIZE * 2, 0, 0, NULL, 0);
+    uart_channel_t* channel = &uart_channels[channel_index];
+    err = uart_driver_install(uart_num, RX_BUF_SIZE * 2, TX_BUF_SIZE, UART_EVENT_QUEUE_LEN, &channel->event_queue, 0);
     if (err != ESP_OK) {
         ESP_LOGE(UART_TOOL_TAG, "Failed to install UART driver for UART%d: %s", uart_num, esp_err_to_name(err));
         return err;
     }
 
+    // 事件队列交给共用的 I/O 任务等待
+    err = uart_io_watch((QueueSetMemberHandle_t)channel->event_queue);
+    if (err != ESP_OK) {
+        ESP_LOGE(UART_TOOL_TAG, "Failed to watch UART%d events", uart_num);
+        uart_driver_delete(uart_num);
+        return err;
+    }
+
     // 应用串口参数
     err = uart_param_config(uart_num, &uart_config);
     if (err != ESP_OK) {
@@ -182,33 +586,31 @@ esp_err_t uart_init(uart_port_t uart_num, gpio_num_t tx_pin, gpio_num_t rx_pin,
     }
 
     // 更新通道信息
-    uart_channels[channel_index].uart_num = uart_num;
-    uart_channels[channel_index].tx_pin = tx_pin;
-    uart_channels[channel_index].rx_pin = rx_pin;
-    uart_channels[channel_index].baud_rate = baud_rate;
-    uart_channels[channel_index].callback = callback;
-    uart_channels[channel_index].terminator = '\n'; // 默认终止符为换行符
-    uart_channels[channel_index].is_initialized = true;
-
-    // 创建接收任务
-    char task_name[16];
-    snprintf(task_name, sizeof(task_name), "uart_rx_%d", uart_num);
-    
-    BaseType_t task_result = xTaskCreate(
-        uart_rx_task, 
-        task_name, 
-        2048, 
-        &channel_index, 
-        configMAX_PRIORITIES - 1, 
-        &uart_channels[channel_index].rx_task_handle
-    );
-    
-    if (task_result != pdTRUE) {
-        ESP_LOGE(UART_TOOL_TAG, "Failed to create RX task for UART%d", uart_num);
-        uart_driver_delete(uart_num);
-        uart_channels[channel_index].is_initialized = false;
-        return ESP_FAIL;
-    }
+    channel->uart_num = uart_num;
+    channel->tx_pin = tx_pin;
+    channel->rx_pin = rx_pin;
+    channel->baud_rate = baud_rate;
+    channel->callback = callback;
+    channel->terminator = '\n'; // 默认终止符为换行符
+    channel->framed = false;
+    channel->rx_overflows = 0;
+    channel->rx_breaks = 0;
+    channel->rx_errors = 0;
+    channel->rx_ring_full = 0;
+    channel->rx_stale = 0;
+    channel->rx_refill_posted = false;
+    channel->rx_reset_pending = false;
+    channel->tx_signal = NULL;
+    channel->slice_callback = NULL;
+    channel->slice_ctx = NULL;
+    channel->ring_head = 0;
+    channel->ring_tail = 0;
+    uart_frame_decoder_reset(&channel->decoder);
+    channel->is_initialized = true;
+
+    // 线路空闲 3 个符号即上报数据，终止符由硬件模式检测定位
+    uart_set_rx_timeout(uart_num, UART_RX_TOUT_SYMBOLS);
+    uart_apply_pattern(channel);
 
     ESP_LOGI(UART_TOOL_TAG, "UART%d initialized successfully (TX: %d, RX: %d, Baud: %d)", 
              uart_num, tx_pin, rx_pin, baud_rate);
@@ -245,6 +647,129 @@ int uart_send_data(uart_port_t uart_num, const uint8_t* data, size_t length)
     return txBytes;
 }
 
+/**
+ * @brief 以帧格式发送一条消息
+ *
+ * @param uart_num UART端口号
+ * @param payload 负载（如 CBOR）
+ * @param length 负载长度
+ * @return int 实际发送的字节数（编码后），失败返回 -1
+ */
+int uart_send_frame(uart_port_t uart_num, const uint8_t* payload, size_t length)
+{
+    uint8_t encoded[UART_FRAME_ENCODED_MAX(UART_FRAME_MAX_PAYLOAD)];
+    const size_t encoded_len = uart_frame_encode(payload, length, encoded, sizeof(encoded));
+    if (encoded_len == 0) {
+        ESP_LOGE(UART_TOOL_TAG, "Frame too long for UART%d: %d bytes", uart_num, (int)length);
+        return -1;
+    }
+
+    return uart_send_data(uart_num, encoded, encoded_len);
+}
+
+/**
+ * @brief 启用或关闭帧模式
+ *
+ * @param uart_num UART端口号
+ * @param enable true 时按 COBS 帧接收，终止符不再生效
+ * @return esp_err_t ESP-IDF错误码
+ */
+esp_err_t uart_set_framing(uart_port_t uart_num, bool enable)
+{
+    int channel_index = find_uart_channel(uart_num);
+    if (channel_index == -1) {
+        ESP_LOGE(UART_TOOL_TAG, "UART%d not initialized", uart_num);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uart_channel_t* channel = &uart_channels[channel_index];
+    uart_frame_decoder_reset(&channel->decoder);
+    channel->framed = enable;
+    uart_apply_pattern(channel);
+    ESP_LOGI(UART_TOOL_TAG, "Framing %s on UART%d", enable ? "enabled" : "disabled", uart_num);
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取帧解码统计
+ *
+ * @param uart_num UART端口号
+ * @param out 统计输出
+ * @return esp_err_t ESP-IDF错误码
+ */
+esp_err_t uart_get_frame_stats(uart_port_t uart_num, uart_frame_stats_t* out)
+{
+    int channel_index = find_uart_channel(uart_num);
+    if (channel_index == -1 || out == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    *out = uart_channels[channel_index].decoder.stats;
+    return ESP_OK;
+}
+
+/**
+ * @brief 请求 I/O 任务清空接收状态（驱动缓冲、接收环、解码器），并等待其完成
+ *
+ * 解码器与接收环只由 I/O 任务访问；在 I/O 任务内调用时直接执行
+ *
+ * @param channel 通道上下文
+ */
+static void uart_rx_request_reset(uart_channel_t* channel)
+{
+    if (xTaskGetCurrentTaskHandle() == uart_io_task_handle) {
+        uart_rx_resync(channel);
+        return;
+    }
+
+    channel->rx_reset_pending = true;
+    // 投递一个空事件唤醒 I/O 任务；队列满时已有事件待处理，同样会先执行复位
+    const uart_event_t wake = {.type = UART_DATA, .size = 0};
+    xQueueSend(channel->event_queue, &wake, 0);
+
+    for (int i = 0; channel->rx_reset_pending && i < pdMS_TO_TICKS(UART_BAUD_RESET_MS) + 1; i++) {
+        vTaskDelay(1);
+    }
+    if (channel->rx_reset_pending) {
+        ESP_LOGW(UART_TOOL_TAG, "UART%d RX reset still pending", channel->uart_num);
+    }
+}
+
+/**
+ * @brief 运行时切换波特率：等待已排队字节发完后再切换，并丢弃切换瞬间的残帧
+ * 
+ * @param uart_num UART端口号
+ * @param baud_rate 新波特率
+ * @return esp_err_t ESP-IDF错误码，发送未能在时限内完成时返回 ESP_ERR_TIMEOUT 且不切换
+ */
+esp_err_t uart_change_baudrate(uart_port_t uart_num, uint32_t baud_rate)
+{
+    int channel_index = find_uart_channel(uart_num);
+    if (channel_index == -1) {
+        ESP_LOGE(UART_TOOL_TAG, "UART%d not initialized", uart_num);
+        return ESP_ERR_INVALID_STATE;
+    }
+    uart_channel_t* channel = &uart_channels[channel_index];
+
+    // 未发完的字节会以新波特率发出而成为乱码，此时放弃切换
+    esp_err_t err = uart_wait_tx_done(uart_num, pdMS_TO_TICKS(UART_BAUD_TX_DONE_MS));
+    if (err != ESP_OK) {
+        ESP_LOGE(UART_TOOL_TAG, "UART%d TX not drained, keeping baud %lu: %s", uart_num, channel->baud_rate, esp_err_to_name(err));
+        return err;
+    }
+
+    err = uart_set_baudrate(uart_num, baud_rate);
+    if (err != ESP_OK) {
+        ESP_LOGE(UART_TOOL_TAG, "Failed to set UART%d baud %lu: %s", uart_num, baud_rate, esp_err_to_name(err));
+        return err;
+    }
+
+    channel->baud_rate = baud_rate;
+    uart_rx_request_reset(channel);
+    ESP_LOGI(UART_TOOL_TAG, "UART%d baud rate -> %lu", uart_num, baud_rate);
+    return ESP_OK;
+}
+
 /**
  * @brief 设置接收终止符
  * 
@@ -261,6 +786,7 @@ void uart_set_terminator(uart_port_t uart_num, uint8_t terminator)
     }
 
     uart_channels[channel_index].terminator = terminator;
+    uart_apply_pattern(&uart_channels[channel_index]);
     ESP_LOGD(UART_TOOL_TAG, "Set terminator for UART%d to 0x%02X", uart_num, terminator);
 }
 
@@ -285,4 +811,109 @@ esp_err_t uart_set_receive_callback(uart_port_t uart_num, uart_receive_callback_
     ESP_LOGI(UART_TOOL_TAG, "Set receive callback for UART%d", uart_num);
     
     return ESP_OK;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 设置零拷贝切片回调，设置后非帧模式的数据改由切片交付
+ * 
+ * @param uart_num UART端口号
+ * @param callback 切片回调，NULL 恢复普通回调
+ * @param ctx 回调上下文
+ * @return esp_err_t ESP-IDF错误码
+ */
+esp_err_t uart_set_slice_callback(uart_port_t uart_num, uart_slice_callback_t callback, void* ctx)
+{
+    int channel_index = find_uart_channel(uart_num);
+    if (channel_index == -1) {
+        ESP_LOGE(UART_TOOL_TAG, "UART%d not initialized", uart_num);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uart_channels[channel_index].slice_ctx = ctx;
+    uart_channels[channel_index].slice_callback = callback;
+    uart_apply_pattern(&uart_channels[channel_index]);
+    return ESP_OK;
+}
+
+/**
+ * @brief 释放切片回调已消费的字节，可在回调内或其他任务中调用
+ *
+ * 接收环满时剩余数据滞留在驱动缓冲，线路空闲后不会再有新事件；
+ * 释放后向事件队列投递一个 UART_DATA 事件，由 I/O 任务补读并再次交付。
+ * 
+ * @param uart_num UART端口号
+ * @param length 释放的字节数（从最早的切片开始）
+ */
+void uart_rx_release(uart_port_t uart_num, size_t length)
+{
+    int channel_index = find_uart_channel(uart_num);
+    if (channel_index == -1) {
+        return;
+    }
+
+    uart_channel_t* channel = &uart_channels[channel_index];
+    uart_ring_release(channel, length);
+
+    size_t buffered = 0;
+    if (channel->rx_refill_posted || uart_get_buffered_data_len(uart_num, &buffered) != ESP_OK || buffered == 0) {
+        return;
+    }
+
+    // 队列满时已有事件待处理，同样会触发补读
+    const uart_event_t refill = {.type = UART_DATA, .size = buffered};
+    channel->rx_refill_posted = true;
+    if (xQueueSend(channel->event_queue, &refill, 0) != pdTRUE) {
+        channel->rx_refill_posted = false;
+    }
+}
+
+/**
+ * @brief 将发送调度的信号量加入队列集，由 I/O 任务代替独立的发送任务写出
+ * 
+ * @param uart_num UART端口号
+ * @param signal 有消息待发时释放的二值信号量（当前须未被释放）
+ * @return esp_err_t ESP-IDF错误码
+ */
+esp_err_t uart_attach_tx_signal(uart_port_t uart_num, SemaphoreHandle_t signal)
+{
+    int channel_index = find_uart_channel(uart_num);
+    if (channel_index == -1 || signal == NULL) {
+        ESP_LOGE(UART_TOOL_TAG, "UART%d not initialized", uart_num);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uart_channel_t* channel = &uart_channels[channel_index];
+    if (channel->tx_signal != NULL) {
+        return ESP_OK;
+    }
+
+    esp_err_t err = uart_io_watch((QueueSetMemberHandle_t)signal);
+    if (err != ESP_OK) {
+        ESP_LOGE(UART_TOOL_TAG, "Failed to watch UART%d TX signal", uart_num);
+        return err;
+    }
+    channel->tx_signal = signal;
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取 I/O 任务统计
+ * 
+ * @param out 统计输出
+ * @return esp_err_t ESP-IDF错误码
+ */
+esp_err_t uart_io_get_stats(uart_io_stats_t* out)
+{
+    if (out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *out = uart_io_stats;
+    out->channels = 0;
+    for (int i = 0; i < UART_CHANNEL_MAX; i++) {
+        if (uart_channels[i].is_initialized) {
+            out->channels++;
+        }
+    }
+    return ESP_OK;
+}
@@ -8,13 +8,35 @@
 #include "driver/uart.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "soc/gpio_num.h"
+#include "frame.h"
 
 // UART接收回调函数指针类型定义
 typedef void (*uart_receive_callback_t)(const uint8_t* data, size_t length);
 
+// 指向通道接收环内部的连续数据段
+typedef struct {
+    const uint8_t* data;
+    size_t length;
+} uart_slice_t;
+
+// 零拷贝接收回调：数据跨越环尾时分为两段，消费后需调用 uart_rx_release
+typedef void (*uart_slice_callback_t)(uart_port_t uart_num, const uart_slice_t* slices, int count, void* ctx);
+
+// 共用 I/O 任务的运行负载统计（累计计数，只反映当前配置下的负载，并非通道数扩展的对比测试）
+typedef struct {
+    uint32_t wakeups;           // 队列集唤醒次数
+    uint32_t rx_events;         // 处理的驱动事件数
+    uint32_t tx_flushes;        // 发送信号触发的写出次数
+    uint32_t tx_retries;        // TX 环满后的定时重试次数
+    uint64_t busy_us;           // 累计处理耗时
+    uint32_t max_dispatch_us;   // 单次唤醒最长处理耗时
+    uint8_t channels;           // 已初始化通道数
+} uart_io_stats_t;
+
 /**
- * @brief 初始化UART通道
+ * @brief 初始化UART通道（所有通道共用一个 I/O 任务，首次调用时创建）
  * 
  * @param uart_num UART端口号
  * @param tx_pin TX引脚
@@ -35,6 +57,59 @@ esp_err_t uart_init(uart_port_t uart_num, gpio_num_t tx_pin, gpio_num_t rx_pin,
  */
 int uart_send_data(uart_port_t uart_num, const uint8_t* data, size_t length);
 
+/**
+ * @brief 以 COBS + CRC16 帧格式发送一条消息
+ * 
+ * @param uart_num UART端口号
+ * @param payload 负载
+ * @param length 负载长度（不超过 UART_FRAME_MAX_PAYLOAD）
+ * @return int 实际发送的字节数，失败返回 -1
+ */
+int uart_send_frame(uart_port_t uart_num, const uint8_t* payload, size_t length);
+
+/**
+ * @brief 启用或关闭帧模式，启用后回调按完整帧的真实长度触发
+ * 
+ * @param uart_num UART端口号
+ * @param enable 是否启用
+ * @return esp_err_t ESP-IDF错误码
+ */
+esp_err_t uart_set_framing(uart_port_t uart_num, bool enable);
+
+/**
+ * @brief 获取帧解码统计
+ */
+esp_err_t uart_get_frame_stats(uart_port_t uart_num, uart_frame_stats_t* out);
+
+/**
+ * @brief 设置零拷贝切片回调，切片直接指向通道的静态接收环
+ * 
+ * @param uart_num UART端口号
+ * @param callback 切片回调，NULL 恢复普通回调
+ * @param ctx 回调上下文
+ * @return esp_err_t ESP-IDF错误码
+ */
+esp_err_t uart_set_slice_callback(uart_port_t uart_num, uart_slice_callback_t callback, void* ctx);
+
+/**
+ * @brief 释放已消费的字节，未释放的数据会在下次回调中再次交付
+ *
+ * 驱动缓冲中仍有滞留数据时会唤醒 I/O 任务补读，无需等待新的接收事件
+ * 
+ * @param uart_num UART端口号
+ * @param length 释放的字节数
+ */
+void uart_rx_release(uart_port_t uart_num, size_t length);
+
+/**
+ * @brief 运行时切换波特率（等待发送完成后切换，接收状态由 I/O 任务复位）
+ * 
+ * @param uart_num UART端口号
+ * @param baud_rate 新波特率
+ * @return esp_err_t ESP-IDF错误码，发送未能按时完成返回 ESP_ERR_TIMEOUT，波特率保持不变
+ */
+esp_err_t uart_change_baudrate(uart_port_t uart_num, uint32_t baud_rate);
+
 /**
  * @brief 设置接收终止符
  * 
@@ -43,4 +118,21 @@ int uart_send_data(uart_port_t uart_num, const uint8_t* data, size_t length);
  */
 void uart_set_terminator(uart_port_t uart_num, uint8_t terminator);
 
+/**
+ * @brief 将发送调度信号量交给 I/O 任务等待
+ * 
+ * @param uart_num UART端口号
+ * @param signal 有消息待发时释放的二值信号量
+ * @return esp_err_t ESP-IDF错误码
+ */
+esp_err_t uart_attach_tx_signal(uart_port_t uart_num, SemaphoreHandle_t signal);
+
+/**
+ * @brief 获取 I/O 任务统计
+ * 
+ * @param out 统计输出
+ * @return esp_err_t ESP-IDF错误码
+ */
+esp_err_t uart_io_get_stats(uart_io_stats_t* out);
+
 #endif //WASTERWATER_MCU_UART_H
\ No newline at end of file
@@ -0,0 +1,363 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+#include "uart_tx.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "frame.h"
+#include "uart.h"
+
+static const char* TAG = "UART_TX";
+
+#if UART_TX_SLOT_SIZE > UART_TX_BATCH_SIZE
+#error "UART_TX_SLOT_SIZE must fit in one batch, otherwise a full slot can never be flushed"
+#endif
+
+typedef struct
+{
+    uint16_t length;
+    uint16_t key;
+    uint8_t data[UART_TX_SLOT_SIZE];
+} uart_tx_slot_t;
+
+/* 槽索引组成的先进先出队列 */
+typedef struct
+{
+    uint8_t idx[UART_TX_SLOTS];
+    uint8_t head;
+    uint8_t count;
+} uart_tx_lane_t;
+
+typedef struct
+{
+    bool started;
+    bool framed;
+    uart_port_t uart_num;
+    SemaphoreHandle_t lock;
+    SemaphoreHandle_t signal;
+    uart_tx_slot_t slots[UART_TX_SLOTS];
+    uint32_t free_mask;                 // 空闲槽位图
+    uart_tx_lane_t lanes[UART_TX_LANES]; // 按 uart_tx_prio_t 索引，发送时依次取
+    uint8_t batch[UART_TX_BATCH_SIZE];
+    uart_tx_stats_t stats;
+} uart_tx_ctx_t;
+
+static uart_tx_ctx_t s_tx[UART_NUM_MAX];
+
+/* -------------------------------------------------------------------------- */
+/*                                 槽与队列                                     */
+/* -------------------------------------------------------------------------- */
+
+static int slot_alloc(uart_tx_ctx_t* ctx)
+{
+    if (ctx->free_mask == 0)
+    {
+        return -1;
+    }
+    const int i = __builtin_ctz(ctx->free_mask);
+    ctx->free_mask &= ~(1u << i);
+    return i;
+}
+
+static void slot_free(uart_tx_ctx_t* ctx, int i)
+{
+    ctx->free_mask |= 1u << i;
+}
+
+static void lane_push(uart_tx_lane_t* lane, int slot)
+{
+    lane->idx[(lane->head + lane->count) % UART_TX_SLOTS] = (uint8_t)slot;
+    lane->count++;
+}
+
+static int lane_peek(const uart_tx_lane_t* lane)
+{
+    return lane->count ? lane->idx[lane->head] : -1;
+}
+
+static int lane_pop(uart_tx_lane_t* lane)
+{
+    if (lane->count == 0)
+    {
+        return -1;
+    }
+    const int slot = lane->idx[lane->head];
+    lane->head = (lane->head + 1) % UART_TX_SLOTS;
+    lane->count--;
+    return slot;
+}
+
+/**
+ * @brief 为新消息取得槽位，必要时挤掉最旧的普通消息
+ */
+static int slot_acquire(uart_tx_ctx_t* ctx, uart_tx_prio_t prio)
+{
+    uart_tx_lane_t* bulk = &ctx->lanes[UART_TX_PRIO_BULK];
+
+    // 应答不可丢弃，达到配额时由调用方重试
+    if (prio == UART_TX_PRIO_REPLY && ctx->lanes[UART_TX_PRIO_REPLY].count >= UART_TX_REPLY_MAX)
+    {
+        return -1;
+    }
+
+    // 普通消息有配额上限，保证告警始终有槽可用
+    if (prio == UART_TX_PRIO_BULK && bulk->count >= UART_TX_BULK_MAX)
+    {
+        ctx->stats.dropped_oldest++;
+        return lane_pop(bulk);
+    }
+
+    int slot = slot_alloc(ctx);
+    if (slot < 0 && bulk->count > 0)
+    {
+        ctx->stats.dropped_oldest++;
+        slot = lane_pop(bulk);
+    }
+    return slot;
+}
+
+/**
+ * @brief 写入槽位；失败时槽内容已不可用，长度置 0，出队时按空消息丢弃
+ */
+static bool slot_fill(uart_tx_ctx_t* ctx, uart_tx_slot_t* slot, const uint8_t* data, size_t length, uint16_t key)
+{
+    size_t n = length;
+    if (ctx->framed)
+    {
+        n = uart_frame_encode(data, length, slot->data, sizeof(slot->data));
+    }
+    else if (length <= sizeof(slot->data))
+    {
+        memcpy(slot->data, data, length);
+    }
+    else
+    {
+        n = 0;
+    }
+    if (n == 0)
+    {
+        slot->length = 0;
+        slot->key = UART_TX_KEY_NONE;
+        return false;
+    }
+    slot->length = (uint16_t)n;
+    slot->key = key;
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   发送                                      */
+/* -------------------------------------------------------------------------- */
+
+esp_err_t uart_tx_send(uart_port_t uart_num, const uint8_t* data, size_t length, uart_tx_prio_t prio, uint16_t key)
+{
+    if (uart_num < 0 || uart_num >= UART_NUM_MAX || data == NULL || prio > UART_TX_PRIO_BULK)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uart_tx_ctx_t* ctx = &s_tx[uart_num];
+    if (!ctx->started)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (length > UART_TX_MAX_PAYLOAD)
+    {
+        ctx->stats.rejected++;
+        ESP_LOGW(TAG, "UART%d message of %u bytes exceeds slot limit %d", uart_num, (unsigned)length, UART_TX_MAX_PAYLOAD);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+
+    // 同键普通消息原位覆盖，队列位置不变，只保留最新值
+    if (prio == UART_TX_PRIO_BULK && key != UART_TX_KEY_NONE)
+    {
+        uart_tx_lane_t* bulk = &ctx->lanes[UART_TX_PRIO_BULK];
+        for (int i = 0; i < bulk->count; i++)
+        {
+            uart_tx_slot_t* slot = &ctx->slots[bulk->idx[(bulk->head + i) % UART_TX_SLOTS]];
+            if (slot->key == key)
+            {
+                if (slot_fill(ctx, slot, data, length, key))
+                {
+                    ctx->stats.coalesced++;
+                }
+                else
+                {
+                    // 旧值已被覆盖，空槽留在原位由发送端跳过
+                    ctx->stats.rejected++;
+                    err = ESP_ERR_INVALID_SIZE;
+                }
+                xSemaphoreGive(ctx->lock);
+                return err;
+            }
+        }
+    }
+
+    const int slot = slot_acquire(ctx, prio);
+    if (slot < 0)
+    {
+        ctx->stats.rejected++;
+        err = ESP_ERR_NO_MEM;
+    }
+    else if (!slot_fill(ctx, &ctx->slots[slot], data, length, key))
+    {
+        slot_free(ctx, slot);
+        ctx->stats.rejected++;
+        err = ESP_ERR_INVALID_SIZE;
+    }
+    else
+    {
+        lane_push(&ctx->lanes[prio], slot);
+        ctx->stats.queued++;
+    }
+    xSemaphoreGive(ctx->lock);
+
+    if (err == ESP_OK)
+    {
+        xSemaphoreGive(ctx->signal);
+    }
+    return err;
+}
+
+int uart_tx_flush(uart_port_t uart_num)
+{
+    if (uart_num < 0 || uart_num >= UART_NUM_MAX || !s_tx[uart_num].started)
+    {
+        return -1;
+    }
+    uart_tx_ctx_t* ctx = &s_tx[uart_num];
+    int total = 0;
+
+    while (1)
+    {
+        size_t len = 0;
+        uint32_t msgs = 0;
+
+        // 只取驱动 TX 环放得下的消息，写入不会阻塞 I/O 任务；放不下的留待下次
+        size_t room = sizeof(ctx->batch);
+        if (uart_get_tx_buffer_free_size(uart_num, &room) != ESP_OK || room > sizeof(ctx->batch))
+        {
+            room = sizeof(ctx->batch);
+        }
+
+        // 告警、应答先于普通消息；多条小消息拼接为一次驱动写入
+        xSemaphoreTake(ctx->lock, portMAX_DELAY);
+        for (int prio = UART_TX_PRIO_ALARM; prio <= UART_TX_PRIO_BULK; prio++)
+        {
+            uart_tx_lane_t* lane = &ctx->lanes[prio];
+            int slot;
+            while ((slot = lane_peek(lane)) >= 0 && len + ctx->slots[slot].length <= room)
+            {
+                memcpy(&ctx->batch[len], ctx->slots[slot].data, ctx->slots[slot].length);
+                len += ctx->slots[slot].length;
+                msgs += ctx->slots[slot].length ? 1 : 0; // 合并失败留下的空槽不计数
+                lane_pop(lane);
+                slot_free(ctx, slot);
+            }
+            if (lane->count > 0)
+            {
+                break; // 批次已满，剩余消息保持顺序留到下一批
+            }
+        }
+        xSemaphoreGive(ctx->lock);
+
+        if (len == 0)
+        {
+            return total;
+        }
+
+        // 已确认 TX 环有足够空间，拷贝后立即返回
+        const int written = uart_write_bytes(uart_num, ctx->batch, len);
+        if (written < 0)
+        {
+            ESP_LOGE(TAG, "UART%d write failed", uart_num);
+            return total;
+        }
+        total += written;
+        ctx->stats.sent += msgs;
+        ctx->stats.batches++;
+    }
+}
+
+esp_err_t uart_tx_start(uart_port_t uart_num, bool framed)
+{
+    if (uart_num < 0 || uart_num >= UART_NUM_MAX)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uart_tx_ctx_t* ctx = &s_tx[uart_num];
+    if (ctx->started)
+    {
+        return ESP_OK;
+    }
+
+    ctx->uart_num = uart_num;
+    ctx->framed = framed;
+    ctx->free_mask = (UART_TX_SLOTS >= 32) ? 0xFFFFFFFFu : ((1u << UART_TX_SLOTS) - 1);
+    memset(ctx->lanes, 0, sizeof(ctx->lanes));
+    memset(&ctx->stats, 0, sizeof(ctx->stats));
+
+    ctx->lock = xSemaphoreCreateMutex();
+    ctx->signal = xSemaphoreCreateBinary();
+    if (ctx->lock == NULL || ctx->signal == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 不再单独建任务，由 UART 共用的 I/O 任务在信号量释放后调用 uart_tx_flush
+    ctx->started = true;
+    esp_err_t err = uart_attach_tx_signal(uart_num, ctx->signal);
+    if (err != ESP_OK)
+    {
+        ctx->started = false;
+        return err;
+    }
+
+    ESP_LOGI(TAG, "TX scheduler started on UART%d (%s)", uart_num, framed ? "framed" : "raw");
+    return ESP_OK;
+}
+
+SemaphoreHandle_t uart_tx_signal(uart_port_t uart_num)
+{
+    if (uart_num < 0 || uart_num >= UART_NUM_MAX || !s_tx[uart_num].started)
+    {
+        return NULL;
+    }
+    return s_tx[uart_num].signal;
+}
+
+bool uart_tx_idle(uart_port_t uart_num)
+{
+    if (uart_num < 0 || uart_num >= UART_NUM_MAX || !s_tx[uart_num].started)
+    {
+        return true;
+    }
+
+    xSemaphoreTake(s_tx[uart_num].lock, portMAX_DELAY);
+    bool idle = true;
+    for (int prio = 0; prio < UART_TX_LANES; prio++)
+    {
+        idle = idle && s_tx[uart_num].lanes[prio].count == 0;
+    }
+    xSemaphoreGive(s_tx[uart_num].lock);
+    return idle;
+}
+
+esp_err_t uart_tx_get_stats(uart_port_t uart_num, uart_tx_stats_t* out)
+{
+    if (uart_num < 0 || uart_num >= UART_NUM_MAX || out == NULL || !s_tx[uart_num].started)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_tx[uart_num].lock, portMAX_DELAY);
+    *out = s_tx[uart_num].stats;
+    xSemaphoreGive(s_tx[uart_num].lock);
+    return ESP_OK;
+}
@@ -0,0 +1,85 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+#ifndef HEALTHY_MCU_UART_TX_H
+#define HEALTHY_MCU_UART_TX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "driver/uart.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "frame.h"
+
+#define UART_TX_SLOTS       16      // 每通道消息槽数量
+#define UART_TX_BULK_MAX    12      // 普通消息最多占用的槽，其余留给告警
+#define UART_TX_REPLY_MAX   8       // 应答最多占用的槽，保证告警总能挤到普通消息或空槽
+#define UART_TX_MAX_PAYLOAD 250     // 单条消息负载上限，小于帧层的 UART_FRAME_MAX_PAYLOAD
+#define UART_TX_SLOT_SIZE   UART_FRAME_ENCODED_MAX(UART_TX_MAX_PAYLOAD) // 槽按编码后最坏长度分配（256）
+#define UART_TX_BATCH_SIZE  512     // 合并写入驱动的最大字节数
+
+typedef enum
+{
+    UART_TX_PRIO_ALARM = 0,     // 告警：优先发送，可挤占普通消息
+    UART_TX_PRIO_REPLY,         // RPC 应答：从不被挤掉，可挤占普通消息；无槽时返回 ESP_ERR_NO_MEM
+    UART_TX_PRIO_BULK,          // 普通遥测
+} uart_tx_prio_t;
+
+#define UART_TX_LANES       (UART_TX_PRIO_BULK + 1)
+
+#define UART_TX_KEY_NONE    0   // 不参与按键合并
+
+typedef struct
+{
+    uint32_t queued;            // 入队消息数
+    uint32_t sent;              // 已写入驱动的消息数
+    uint32_t batches;           // 合并写入次数
+    uint32_t coalesced;         // 被同键新值覆盖的消息
+    uint32_t dropped_oldest;    // 队列满丢弃的最旧普通消息
+    uint32_t rejected;          // 无法入队的消息
+} uart_tx_stats_t;
+
+/**
+ * @brief 为已初始化的 UART 通道启动发送调度
+ *
+ * @param uart_num UART端口号
+ * @param framed 入队时是否按 COBS 帧编码
+ */
+esp_err_t uart_tx_start(uart_port_t uart_num, bool framed);
+
+/**
+ * @brief 非阻塞入队一条消息
+ *
+ * key 非 0 的普通消息与队列中同键的旧消息合并（旧值被替换）；
+ * 队列满时丢弃最旧的普通消息。告警与应答只挤占普通消息，自身不会被丢弃，
+ * 没有可挤占的槽时返回 ESP_ERR_NO_MEM。调用者不会因串口速率而阻塞。
+ *
+ * @param uart_num UART端口号
+ * @param data 负载
+ * @param length 负载长度
+ * @param prio 优先级通道
+ * @param key 合并键，UART_TX_KEY_NONE 表示不合并
+ */
+esp_err_t uart_tx_send(uart_port_t uart_num, const uint8_t* data, size_t length, uart_tx_prio_t prio, uint16_t key);
+
+/**
+ * @brief 有消息待发时被释放的信号量，可加入 QueueSet
+ */
+SemaphoreHandle_t uart_tx_signal(uart_port_t uart_num);
+
+/**
+ * @brief 取出待发消息合并写入驱动 TX 环，返回写入字节数
+ */
+int uart_tx_flush(uart_port_t uart_num);
+
+/**
+ * @brief 两条队列是否都已清空（已全部写入驱动）
+ */
+bool uart_tx_idle(uart_port_t uart_num);
+
+esp_err_t uart_tx_get_stats(uart_port_t uart_num, uart_tx_stats_t* out);
+
+#endif //HEALTHY_MCU_UART_TX_H
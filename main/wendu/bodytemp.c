@@ -0,0 +1,80 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+#include "bodytemp.h"
+
+#include <math.h>
+#include <string.h>
+
+#define KELVIN 273.15f
+
+/*
+ * 发射率修正：传感器按 ε_s 换算出的温度 T_m 满足
+ * ε_s·T_m⁴ = ε·T⁴ + (1-ε)·T_a⁴（均为开尔文），解出真实表面温度 T
+ */
+static float emissivity_correct(float object_c, float ambient_c)
+{
+    float tm = object_c + KELVIN;
+    float ta = ambient_c + KELVIN;
+    float t4 = (BODYTEMP_SENSOR_EMISSIVITY * tm * tm * tm * tm
+                - (1.0f - BODYTEMP_SKIN_EMISSIVITY) * ta * ta * ta * ta) / BODYTEMP_SKIN_EMISSIVITY;
+    return sqrtf(sqrtf(t4)) - KELVIN;
+}
+
+void bodytemp_reset(bodytemp_t* bt)
+{
+    memset(bt, 0, sizeof(*bt));
+}
+
+bool bodytemp_update(bodytemp_t* bt, float object_c, float ambient_c)
+{
+    float z = emissivity_correct(object_c, ambient_c);
+
+    if (!bt->initialized)
+    {
+        bt->x = z;
+        bt->p = BODYTEMP_MEAS_NOISE;
+        bt->ambient = ambient_c;
+        bt->samples = 1;
+        bt->initialized = true;
+        return true;
+    }
+
+    // 预测
+    bt->p += BODYTEMP_PROCESS_NOISE;
+
+    // 新息门限，剔除手部移动等造成的离群值
+    float innovation = z - bt->x;
+    float s = bt->p + BODYTEMP_MEAS_NOISE;
+    if (innovation * innovation > BODYTEMP_GATE_SIGMA * BODYTEMP_GATE_SIGMA * s)
+    {
+        bt->rejected++;
+        // 连续被剔除说明目标已改变，重新初始化
+        if (bt->rejected > BODYTEMP_MIN_SAMPLES)
+        {
+            bodytemp_reset(bt);
+            return bodytemp_update(bt, object_c, ambient_c);
+        }
+        return false;
+    }
+    bt->rejected = 0;
+
+    // 更新
+    float k = bt->p / s;
+    bt->x += k * innovation;
+    bt->p *= 1.0f - k;
+    bt->ambient += 0.1f * (ambient_c - bt->ambient);
+    bt->samples++;
+    return true;
+}
+
+float bodytemp_estimate(const bodytemp_t* bt)
+{
+    return bt->x + BODYTEMP_HEAT_COEFF * (bt->x - bt->ambient);
+}
+
+bool bodytemp_converged(const bodytemp_t* bt)
+{
+    return bt->initialized && bt->samples >= BODYTEMP_MIN_SAMPLES && bt->p < BODYTEMP_CONVERGE_VAR;
+}
@@ -0,0 +1,61 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+#ifndef HEALTHY_MCU_BODYTEMP_H
+#define HEALTHY_MCU_BODYTEMP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * 额温 -> 体温估计
+ * 物体温度经发射率修正得到皮肤温度，一维卡尔曼滤波平滑，
+ * 再按环境温度做热平衡补偿；估计方差低于门限即判定收敛。
+ */
+
+#define BODYTEMP_SKIN_EMISSIVITY    0.98f   // 人体皮肤发射率
+#define BODYTEMP_SENSOR_EMISSIVITY  1.00f   // MLX90614 EEPROM 中的发射率设置（出厂 1.0）
+#define BODYTEMP_HEAT_COEFF         0.19f   // 额头热平衡系数：体温 = 皮肤 + k*(皮肤 - 环境)，需标定
+#define BODYTEMP_PROCESS_NOISE      0.00005f // 过程噪声 Q（℃²/次），稳态方差约 sqrt(QR) 须低于收敛门限
+#define BODYTEMP_MEAS_NOISE         0.04f   // 测量噪声 R（℃²），约 0.2℃ 标准差
+#define BODYTEMP_CONVERGE_VAR       0.0025f // 方差低于该值（0.05℃ 标准差）判定收敛
+#define BODYTEMP_MIN_SAMPLES        5       // 最少样本数
+#define BODYTEMP_GATE_SIGMA         3.0f    // 新息超过 3 倍标准差视为离群值
+
+typedef struct
+{
+    float x;                // 皮肤温度估计 ℃
+    float p;                // 估计方差
+    float ambient;          // 环境温度（一阶平滑）
+    uint32_t samples;       // 已接受样本数
+    uint32_t rejected;      // 被门限剔除的样本数
+    bool initialized;
+} bodytemp_t;
+
+/**
+ * @brief 开始新的测量
+ */
+void bodytemp_reset(bodytemp_t* bt);
+
+/**
+ * @brief 输入一组物体 / 环境温度
+ *
+ * @param bt 估计器
+ * @param object_c 物体温度 ℃
+ * @param ambient_c 环境温度 ℃
+ * @return bool 该样本是否被接受
+ */
+bool bodytemp_update(bodytemp_t* bt, float object_c, float ambient_c);
+
+/**
+ * @brief 当前体温估计 ℃
+ */
+float bodytemp_estimate(const bodytemp_t* bt);
+
+/**
+ * @brief 估计是否已收敛
+ */
+bool bodytemp_converged(const bodytemp_t* bt);
+
+#endif //HEALTHY_MCU_BODYTEMP_H
@@ -1,74 +1,225 @@
 #include "hongwai.h"
-#include "driver/i2c_master.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "myi2c.h"
 #include <stdint.h>
 
+static const char* TAG = "MLX90614";
+
 // 全局变量定义
 float a_temp = 0;
 float o_temp = 0;
 
-// 内部硬件句柄
-static i2c_master_dev_handle_t dev_handle = NULL;
+// 共享总线上的设备句柄
+static i2c_bus_dev_handle_t dev_handle = NULL;
+
+// 帧统计
+static mlx90614_stats_t s_stats = {0};
+
+// 电源管理
+static volatile mlx90614_power_t s_power = MLX90614_POWER_AWAKE;
+static int64_t s_ready_at = 0;
+
+/*
+ * SMBus PEC：CRC-8，多项式 x^8 + x^2 + x + 1 (0x07)，初值 0
+ */
+static const uint8_t s_crc8_table[256] = {
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15, 0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D,
+    0x70, 0x77, 0x7E, 0x79, 0x6C, 0x6B, 0x62, 0x65, 0x48, 0x4F, 0x46, 0x41, 0x54, 0x53, 0x5A, 0x5D,
+    0xE0, 0xE7, 0xEE, 0xE9, 0xFC, 0xFB, 0xF2, 0xF5, 0xD8, 0xDF, 0xD6, 0xD1, 0xC4, 0xC3, 0xCA, 0xCD,
+    0x90, 0x97, 0x9E, 0x99, 0x8C, 0x8B, 0x82, 0x85, 0xA8, 0xAF, 0xA6, 0xA1, 0xB4, 0xB3, 0xBA, 0xBD,
+    0xC7, 0xC0, 0xC9, 0xCE, 0xDB, 0xDC, 0xD5, 0xD2, 0xFF, 0xF8, 0xF1, 0xF6, 0xE3, 0xE4, 0xED, 0xEA,
+    0xB7, 0xB0, 0xB9, 0xBE, 0xAB, 0xAC, 0xA5, 0xA2, 0x8F, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9D, 0x9A,
+    0x27, 0x20, 0x29, 0x2E, 0x3B, 0x3C, 0x35, 0x32, 0x1F, 0x18, 0x11, 0x16, 0x03, 0x04, 0x0D, 0x0A,
+    0x57, 0x50, 0x59, 0x5E, 0x4B, 0x4C, 0x45, 0x42, 0x6F, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7D, 0x7A,
+    0x89, 0x8E, 0x87, 0x80, 0x95, 0x92, 0x9B, 0x9C, 0xB1, 0xB6, 0xBF, 0xB8, 0xAD, 0xAA, 0xA3, 0xA4,
+    0xF9, 0xFE, 0xF7, 0xF0, 0xE5, 0xE2, 0xEB, 0xEC, 0xC1, 0xC6, 0xCF, 0xC8, 0xDD, 0xDA, 0xD3, 0xD4,
+    0x69, 0x6E, 0x67, 0x60, 0x75, 0x72, 0x7B, 0x7C, 0x51, 0x56, 0x5F, 0x58, 0x4D, 0x4A, 0x43, 0x44,
+    0x19, 0x1E, 0x17, 0x10, 0x05, 0x02, 0x0B, 0x0C, 0x21, 0x26, 0x2F, 0x28, 0x3D, 0x3A, 0x33, 0x34,
+    0x4E, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5C, 0x5B, 0x76, 0x71, 0x78, 0x7F, 0x6A, 0x6D, 0x64, 0x63,
+    0x3E, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2C, 0x2B, 0x06, 0x01, 0x08, 0x0F, 0x1A, 0x1D, 0x14, 0x13,
+    0xAE, 0xA9, 0xA0, 0xA7, 0xB2, 0xB5, 0xBC, 0xBB, 0x96, 0x91, 0x98, 0x9F, 0x8A, 0x8D, 0x84, 0x83,
+    0xDE, 0xD9, 0xD0, 0xD7, 0xC2, 0xC5, 0xCC, 0xCB, 0xE6, 0xE1, 0xE8, 0xEF, 0xFA, 0xFD, 0xF4, 0xF3,
+};
+
+static uint8_t crc8_update(uint8_t crc, const uint8_t* data, size_t len)
+{
+    while (len--)
+    {
+        crc = s_crc8_table[crc ^ *data++];
+    }
+    return crc;
+}
 
 void MLX90614_Init(void)
 {
-    // 1. 总线配置 (对应你提供的 i2c_master_bus_config_t 结构体)
-    i2c_master_bus_config_t bus_config = {
-        .i2c_port = -1,                   // 自动选择可用端口
-        .sda_io_num = GPIO_NUM_7,         // 根据实际连接修改
-        .scl_io_num = GPIO_NUM_6,         // 根据实际连接修改
-        .clk_source = I2C_CLK_SRC_DEFAULT,
-        .glitch_ignore_cnt = 7,
-        .intr_priority = 0,               // 默认优先级
-        .trans_queue_depth = 0,           // 阻塞模式设为0即可
-        .flags.enable_internal_pullup = 1,
-    };
-
-    i2c_master_bus_handle_t bus_handle;
-    ESP_ERROR_CHECK(i2c_new_master_bus(&bus_config, &bus_handle));
-
-    // 2. 设备配置 (速率在这里设置！)
-    i2c_device_config_t dev_config = {
-        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-        .device_address = 0x5A,           // MLX90614 默认地址
-        .scl_speed_hz = 100000,           // 100kHz，这是硬件 I2C 的频率控制
-    };
-    ESP_ERROR_CHECK(i2c_master_bus_add_device(bus_handle, &dev_config, &dev_handle));
+    // MLX90614 与 MAX30102 共用 myi2c 管理的总线，SMBus 最高 100kHz
+    ESP_ERROR_CHECK(i2c_bus_add_device("mlx90614", 0x5A, 100000, &dev_handle));
+    // 100kHz 下 3 字节读取约 0.5ms，留出时钟延展余量
+    i2c_bus_set_deadline(dev_handle, 5);
 }
 
-uint32_t MLX90614_ReadReg(uint8_t RegAddress)
+bool MLX90614_CheckPEC(uint8_t RegAddress, const uint8_t rx[3])
 {
-    if (dev_handle == NULL) return 0;
+    // PEC 覆盖整帧：SA+W, Command, SA+R, DataL, DataH
+    const uint8_t hdr[3] = {MLX90614_ADDRESS, RegAddress, MLX90614_ADDRESS | 0x01};
+    uint8_t crc = crc8_update(0, hdr, sizeof(hdr));
+    crc = crc8_update(crc, rx, 2);
+    return crc == rx[2];
+}
+
+esp_err_t MLX90614_ReadWord(uint8_t RegAddress, uint16_t* out)
+{
+    if (dev_handle == NULL || out == NULL) return ESP_ERR_INVALID_STATE;
+    if (s_power == MLX90614_POWER_SLEEP) return ESP_ERR_INVALID_STATE;
+
+    esp_err_t err = ESP_FAIL;
+    for (int attempt = 0; attempt < MLX90614_READ_RETRY; attempt++)
+    {
+        uint8_t rx_buf[3]; // MLX90614 返回 DataL, DataH, PEC
+        s_stats.reads++;
+
+        // 硬件底层会自动处理时序，无需手动调用 esp_rom_delay_us
+        err = i2c_bus_write_read(
+            dev_handle,
+            &RegAddress, 1,  // 写入寄存器地址
+            rx_buf, 3,       // 读取 3 字节
+            I2C_MASTER_TIMEOUT_MS
+        );
 
-    uint8_t rx_buf[3]; // MLX90614 返回 DataL, DataH, PEC
+        if (err == I2C_BUS_ERR_QUARANTINED)
+        {
+            // 设备处于隔离期，重试只会继续被拒绝
+            break;
+        }
+        if (err != ESP_OK)
+        {
+            s_stats.bus_errors++;
+            continue;
+        }
 
-    // 硬件底层会自动处理时序，无需手动调用 esp_rom_delay_us
-    esp_err_t err = i2c_master_transmit_receive(
-        dev_handle,
-        &RegAddress, 1,  // 写入寄存器地址
-        rx_buf, 3,       // 读取 3 字节
-        -1               // 阻塞直到完成
-    );
+        if (!MLX90614_CheckPEC(RegAddress, rx_buf))
+        {
+            s_stats.pec_errors++;
+            err = ESP_ERR_INVALID_CRC;
+            continue;
+        }
 
-    if (err != ESP_OK) {
+        *out = (uint16_t)((rx_buf[1] << 8) | rx_buf[0]);
+        return ESP_OK;
+    }
+
+    ESP_LOGD(TAG, "Read 0x%02X failed: %s", RegAddress, esp_err_to_name(err));
+    return err;
+}
+
+uint32_t MLX90614_ReadReg(uint8_t RegAddress)
+{
+    uint16_t value;
+    if (MLX90614_ReadWord(RegAddress, &value) != ESP_OK) {
         return 0;
     }
+    return value;
+}
 
-    return (uint32_t)((rx_buf[1] << 8) | rx_buf[0]);
+esp_err_t MLX90614_ReadRegAsync(uint8_t RegAddress, uint8_t rx[3], i2c_bus_done_cb_t cb, void* ctx)
+{
+    if (dev_handle == NULL) return ESP_ERR_INVALID_STATE;
+
+    return i2c_bus_write_read_async(dev_handle, &RegAddress, 1, rx, 3, cb, ctx);
+}
+
+esp_err_t MLX90614_ReadTemp(uint8_t RegAddress, float* out)
+{
+    uint16_t raw;
+    esp_err_t err = MLX90614_ReadWord(RegAddress, &raw);
+    if (err != ESP_OK) return err;
+
+    // RAM 温度最高位为错误标志
+    if (raw & 0x8000)
+    {
+        s_stats.flag_errors++;
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    // 分辨率 0.02K
+    *out = (float)raw * 0.02f - 273.15f;
+    return ESP_OK;
+}
+
+esp_err_t MLX90614_Sleep(void)
+{
+    if (dev_handle == NULL) return ESP_ERR_INVALID_STATE;
+    if (s_power == MLX90614_POWER_SLEEP) return ESP_OK;
+
+    // 睡眠命令同样需要 PEC：CRC8(SA+W, 0xFF)
+    const uint8_t hdr[1] = {MLX90614_ADDRESS};
+    uint8_t frame[2] = {MLX90614_CMD_SLEEP, 0};
+    frame[1] = crc8_update(crc8_update(0, hdr, 1), frame, 1);
+
+    esp_err_t err = i2c_bus_write(dev_handle, frame, sizeof(frame), I2C_MASTER_TIMEOUT_MS);
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Sleep command failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    s_power = MLX90614_POWER_SLEEP;
+    i2c_device_set_sleeping(0x5A, true);
+    ESP_LOGD(TAG, "Sleep");
+    return ESP_OK;
+}
+
+esp_err_t MLX90614_Wake(void)
+{
+    if (dev_handle == NULL) return ESP_ERR_INVALID_STATE;
+    if (s_power != MLX90614_POWER_SLEEP) return ESP_OK;
+
+    esp_err_t err = i2c_bus_hold_sda_low(MLX90614_WAKE_SDA_LOW_MS);
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Wake sequence failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    s_ready_at = esp_timer_get_time() + MLX90614_WAKE_SETTLE_MS * 1000;
+    s_power = MLX90614_POWER_WAKING;
+    i2c_device_set_sleeping(0x5A, false);
+    ESP_LOGD(TAG, "Wake");
+    return ESP_OK;
+}
+
+bool MLX90614_IsReady(void)
+{
+    if (s_power == MLX90614_POWER_WAKING && esp_timer_get_time() >= s_ready_at)
+    {
+        s_power = MLX90614_POWER_AWAKE;
+    }
+    return s_power == MLX90614_POWER_AWAKE;
+}
+
+mlx90614_power_t MLX90614_GetPowerState(void)
+{
+    MLX90614_IsReady();
+    return s_power;
+}
+
+void MLX90614_GetStats(mlx90614_stats_t* out)
+{
+    *out = s_stats;
 }
 
-// 以下保持原有定义不变
 void MLX90614_TO(void)
 {
-    int i = MLX90614_ReadReg(0x07);
-    if (i == 0) return;
-    i = (i * 2) - 27315;
-    o_temp = i * 0.01f;
+    float t;
+    if (MLX90614_ReadTemp(MLX90614_RAM_TOBJ1, &t) != ESP_OK) return;
+    o_temp = t;
 }
 
 void MLX90614_TA(void)
 {
-    int i = MLX90614_ReadReg(0x06);
-    if (i == 0) return;
-    i = (i * 2) - 27315;
-    a_temp = i * 0.01f;
-}
\ No newline at end of file
+    float t;
+    if (MLX90614_ReadTemp(MLX90614_RAM_TA, &t) != ESP_OK) return;
+    a_temp = t;
+}
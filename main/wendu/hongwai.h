@@ -9,7 +9,7 @@ extern float a_temp; //环境温度
 extern float o_temp; //物体温度
 
 
-#define MLX90614_ADDRESS 			0x5A<<1
+#define MLX90614_ADDRESS 			(0x5A<<1)
 #define MLX90614_RAM_TA				0x06
 #define MLX90614_RAM_TOBJ1			0x07
 #define MLX90614_RAM_TOBJ2			0x08
@@ -17,10 +17,50 @@ extern float o_temp; //物体温度
 #define MLX90614_EEPROM_CONFIG		0x05
 #define MLX90614_EEPROM_SMBUS_ADDR	0x2E
 
+#define MLX90614_READ_RETRY			3    // PEC 或总线错误时的重试次数
+#define MLX90614_CMD_SLEEP			0xFF // 进入睡眠命令
+#define MLX90614_WAKE_SDA_LOW_MS	40   // 唤醒：SDA 拉低 > 33ms
+#define MLX90614_WAKE_SETTLE_MS		250  // 唤醒后首个有效数据的稳定时间
+
 #include <stdint.h>
+#include <stdbool.h>
+#include "myi2c.h"
+
+// 电源状态
+typedef enum
+{
+    MLX90614_POWER_AWAKE = 0,   // 正常工作
+    MLX90614_POWER_SLEEP,       // 睡眠，不响应总线
+    MLX90614_POWER_WAKING,      // 已唤醒，等待数据稳定
+} mlx90614_power_t;
+
+// 帧统计
+typedef struct
+{
+    uint32_t reads;         // 读取帧数（含重试）
+    uint32_t pec_errors;    // PEC 校验失败丢弃的帧
+    uint32_t bus_errors;    // 总线错误
+    uint32_t flag_errors;   // 温度错误标志置位
+} mlx90614_stats_t;
 
 uint32_t MLX90614_ReadReg(uint8_t RegAddress);
+// 读取并校验 PEC，失败自动重试
+esp_err_t MLX90614_ReadWord(uint8_t RegAddress, uint16_t* out);
+// 读取温度寄存器（℃），检查错误标志
+esp_err_t MLX90614_ReadTemp(uint8_t RegAddress, float* out);
+// 校验一帧 DataL/DataH/PEC（供异步读取使用）
+bool MLX90614_CheckPEC(uint8_t RegAddress, const uint8_t rx[3]);
+void MLX90614_GetStats(mlx90614_stats_t* out);
+/* 异步读取寄存器，rx 需容纳 DataL/DataH/PEC 三字节并在回调前保持有效 */
+esp_err_t MLX90614_ReadRegAsync(uint8_t RegAddress, uint8_t rx[3], i2c_bus_done_cb_t cb, void* ctx);
 void MLX90614_Init(void);
+// 进入睡眠（SMBus 睡眠命令，带 PEC）
+esp_err_t MLX90614_Sleep(void);
+// 唤醒，返回后需等待 MLX90614_IsReady()
+esp_err_t MLX90614_Wake(void);
+// 唤醒后数据是否已稳定
+bool MLX90614_IsReady(void);
+mlx90614_power_t MLX90614_GetPowerState(void);
 void MLX90614_TO(void);
 void MLX90614_TA(void);
 
@@ -0,0 +1,106 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+/*
+ * 主机端堆分配检查：链接时 --wrap 掉 malloc/calloc/realloc/free，
+ * 统计 iot_data_encode_cbor / iot_data_decode_cbor 在两种线路格式、全部值类型、
+ * 正常帧与截断帧下的堆调用次数。期望为 0，非 0 时返回失败。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vars.h"
+
+#define ALLOC_ROUNDS    10000
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* p, size_t size);
+void __real_free(void* p);
+
+// malloc 被视为 leaf 调用，计数器不加 volatile 会被编译器缓存
+static volatile int s_armed = 0;
+static volatile unsigned long s_allocs = 0;
+static volatile unsigned long s_frees = 0;
+
+void* __wrap_malloc(size_t size)
+{
+    if (s_armed) s_allocs++;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t n, size_t size)
+{
+    if (s_armed) s_allocs++;
+    return __real_calloc(n, size);
+}
+
+void* __wrap_realloc(void* p, size_t size)
+{
+    if (s_armed) s_allocs++;
+    return __real_realloc(p, size);
+}
+
+void __wrap_free(void* p)
+{
+    if (s_armed && p) s_frees++;
+    __real_free(p);
+}
+
+int main(void)
+{
+    static const char long_str[] = "a string longer than the sso buffer";
+    static const uint8_t bytes[40] = {1, 2, 3};
+    const iot_value_t vals[] = {
+        iot_value_int(-5), iot_value_float(36.6f), iot_value_bool(true),
+        iot_value_str("short"), iot_value_str(long_str),
+        iot_value_bytes(bytes, 4), iot_value_bytes(bytes, sizeof(bytes)),
+    };
+    const val_type_t types[] = {
+        VAL_TYPE_INT, VAL_TYPE_FLOAT, VAL_TYPE_BOOL,
+        VAL_TYPE_STR, VAL_TYPE_STR,
+        VAL_TYPE_BYTE, VAL_TYPE_BYTE,
+    };
+    unsigned long msgs = 0, errs = 0;
+
+    // 自检：确认包装确实生效，否则 0 次没有意义
+    s_armed = 1;
+    free(malloc(1));
+    s_armed = 0;
+    if (s_allocs != 1 || s_frees != 1)
+    {
+        printf("malloc wrap not active (allocs=%lu frees=%lu)\n", s_allocs, s_frees);
+        return 1;
+    }
+    s_allocs = s_frees = 0;
+
+    s_armed = 1;
+    for (int rep = 0; rep < ALLOC_ROUNDS; rep++)
+    {
+        for (int fmt = IOT_WIRE_LEGACY; fmt <= IOT_WIRE_COMPACT; fmt++)
+        {
+            iot_data_set_wire_format((iot_wire_format_t)fmt);
+            for (size_t i = 0; i < sizeof(vals) / sizeof(vals[0]); i++)
+            {
+                iot_data_t d = {
+                    .device_id = "DEV-ESP32-001", .key = "wendu", .type = types[i], .value = vals[i],
+                    .channel = CANNEL_PROPERTY, .timestamp = 1705324800, .rid = (uint32_t)rep,
+                };
+                uint8_t buf[256];
+                iot_data_t r;
+                size_t len = iot_data_encode_cbor(&d, buf, sizeof(buf));
+                if (len == 0 || iot_data_decode_cbor(buf, len, &r) != CborNoError) errs++;
+                // 截断帧必须走错误路径，同样不能分配
+                if (iot_data_decode_cbor(buf, len / 2, &r) == CborNoError) errs++;
+                msgs++;
+            }
+        }
+    }
+    s_armed = 0;
+
+    printf("encode+decode %lu messages (+%lu truncated), %lu errors: malloc/calloc/realloc=%lu free=%lu\n",
+           msgs, msgs, errs, s_allocs, s_frees);
+    return (errs || s_allocs || s_frees) ? 1 : 0;
+}
@@ -0,0 +1,191 @@
+//
+// Created by nebula on 2026/10/18.
+//
+
+/*
+ * 主机端解码基准：main/global/vars.c 与 tinycbor 用 gcc 编译，在 PC 上对比
+ *   legacy_ref  改造前的解码方式（逐字段 cbor_value_map_find_value 重新扫描 Map，值按类型 malloc）
+ *   current     现行 iot_data_decode_cbor（单遍扫描，值内联/借用，不分配）
+ * 同一份编码结果分别交给两者解码，输出每条消息的平均耗时。
+ * 绝对数值只反映主机 CPU，板上的比值需以实测为准。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "vars.h"
+
+#define BENCH_ROUNDS    1000000
+
+static double now_ns(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+}
+
+/* 改造前 iot_data_t 的值是堆上分配的 void* */
+typedef struct
+{
+    char device_id[18];
+    char key[14];
+    void* value;
+    val_type_t type;
+    int8_t channel;
+    uint32_t timestamp;
+    uint32_t rid;
+} legacy_data_t;
+
+/*
+ * 改造前 LEGACY Map 格式的解码流程，逐字段查找，与旧版 vars.c 保持一致
+ */
+static CborError legacy_ref_decode(const uint8_t* buffer, size_t len, legacy_data_t* out_data)
+{
+    CborParser parser;
+    CborValue it, val;
+    CborError err;
+
+    err = cbor_parser_init(buffer, len, 0, &parser, &it);
+    if (err != CborNoError) return err;
+    if (!cbor_value_is_map(&it)) return CborErrorIllegalType;
+
+    cbor_value_map_find_value(&it, "id", &val);
+    size_t id_len = sizeof(out_data->device_id);
+    cbor_value_copy_text_string(&val, out_data->device_id, &id_len, NULL);
+
+    cbor_value_map_find_value(&it, "key", &val);
+    size_t key_len = sizeof(out_data->key);
+    cbor_value_copy_text_string(&val, out_data->key, &key_len, NULL);
+
+    cbor_value_map_find_value(&it, "ty", &val);
+    int type_tmp = 0;
+    cbor_value_get_int(&val, &type_tmp);
+    out_data->type = (val_type_t)type_tmp;
+
+    cbor_value_map_find_value(&it, "val", &val);
+    out_data->value = NULL;
+    switch (out_data->type)
+    {
+    case VAL_TYPE_INT:
+        out_data->value = malloc(sizeof(int));
+        cbor_value_get_int(&val, (int*)out_data->value);
+        break;
+    case VAL_TYPE_FLOAT:
+        out_data->value = malloc(sizeof(float));
+        cbor_value_get_float(&val, (float*)out_data->value);
+        break;
+    case VAL_TYPE_BOOL:
+        out_data->value = malloc(sizeof(bool));
+        cbor_value_get_boolean(&val, (bool*)out_data->value);
+        break;
+    case VAL_TYPE_STR:
+        {
+            size_t s_len = 0;
+            cbor_value_calculate_string_length(&val, &s_len);
+            out_data->value = malloc(s_len + 1);
+            s_len++;
+            cbor_value_copy_text_string(&val, (char*)out_data->value, &s_len, NULL);
+            break;
+        }
+    case VAL_TYPE_BYTE:
+        {
+            size_t b_len = 0;
+            cbor_value_calculate_string_length(&val, &b_len);
+            out_data->value = malloc(b_len ? b_len : 1);
+            cbor_value_copy_byte_string(&val, (uint8_t*)out_data->value, &b_len, NULL);
+            break;
+        }
+    }
+
+    cbor_value_map_find_value(&it, "ts", &val);
+    uint64_t ts_tmp = 0;
+    cbor_value_get_uint64(&val, &ts_tmp);
+    out_data->timestamp = (uint32_t)ts_tmp;
+
+    cbor_value_map_find_value(&it, "ch", &val);
+    int ch_tmp = 0;
+    cbor_value_get_int(&val, &ch_tmp);
+    out_data->channel = (int8_t)ch_tmp;
+
+    out_data->rid = 0;
+    if (cbor_value_map_find_value(&it, "rid", &val) == CborNoError && cbor_value_is_unsigned_integer(&val))
+    {
+        uint64_t rid_tmp;
+        cbor_value_get_uint64(&val, &rid_tmp);
+        out_data->rid = (uint32_t)rid_tmp;
+    }
+
+    return CborNoError;
+}
+
+typedef struct
+{
+    const char* name;
+    iot_data_t msg;
+} bench_case_t;
+
+static double bench_legacy_ref(const uint8_t* buf, size_t len, int* bad)
+{
+    legacy_data_t r;
+    double t0 = now_ns();
+    for (int i = 0; i < BENCH_ROUNDS; i++)
+    {
+        if (legacy_ref_decode(buf, len, &r) != CborNoError) (*bad)++;
+        free(r.value);
+    }
+    return (now_ns() - t0) / BENCH_ROUNDS;
+}
+
+static double bench_current(const uint8_t* buf, size_t len, int* bad)
+{
+    iot_data_t r;
+    double t0 = now_ns();
+    for (int i = 0; i < BENCH_ROUNDS; i++)
+    {
+        if (iot_data_decode_cbor(buf, len, &r) != CborNoError) (*bad)++;
+    }
+    return (now_ns() - t0) / BENCH_ROUNDS;
+}
+
+int main(void)
+{
+    static const char long_str[] = "36.6C measured at forehead, sensor ok";
+    bench_case_t cases[] = {
+        {"float", {.device_id = "DEV-ESP32-001", .key = "wendu", .type = VAL_TYPE_FLOAT,
+                   .value = iot_value_float(36.6f), .channel = CANNEL_PROPERTY, .timestamp = 1705324800}},
+        {"int+rid", {.device_id = "DEV-ESP32-001", .key = "xinlv", .type = VAL_TYPE_INT,
+                     .value = iot_value_int(72), .channel = CANNEL_FUNCTION, .timestamp = 1705324800, .rid = 42}},
+        {"long str", {.device_id = "DEV-ESP32-001", .key = "temp", .type = VAL_TYPE_STR,
+                      .value = iot_value_str(long_str), .channel = CANNEL_EVENT, .timestamp = 1705324800}},
+    };
+    int failed = 0;
+
+    printf("%-10s %-8s %5s %14s %14s %8s\n", "case", "wire", "bytes", "legacy_ref ns", "current ns", "speedup");
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        uint8_t buf[128];
+        int bad = 0;
+
+        // 改造前只有 LEGACY 格式，两个解码器吃同一帧
+        iot_data_set_wire_format(IOT_WIRE_LEGACY);
+        size_t len = iot_data_encode_cbor(&cases[c].msg, buf, sizeof(buf));
+        double t_ref = bench_legacy_ref(buf, len, &bad);
+        double t_cur = bench_current(buf, len, &bad);
+        printf("%-10s %-8s %5zu %14.1f %14.1f %7.2fx\n", cases[c].name, "legacy", len, t_ref, t_cur, t_ref / t_cur);
+
+        // COMPACT 格式只有现行解码器支持
+        iot_data_set_wire_format(IOT_WIRE_COMPACT);
+        len = iot_data_encode_cbor(&cases[c].msg, buf, sizeof(buf));
+        double t_cmp = bench_current(buf, len, &bad);
+        printf("%-10s %-8s %5zu %14s %14.1f %7.2fx\n", cases[c].name, "compact", len, "-", t_cmp, t_ref / t_cmp);
+
+        if (bad)
+        {
+            printf("  %d decode errors\n", bad);
+            failed = 1;
+        }
+    }
+
+    return failed;
+}